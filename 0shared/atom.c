@@ -0,0 +1,292 @@
+/*--------------------------------------------------------------------*/
+/* atom.c                                                             */
+/* Author: John Matters, Daniel Wang                                  */
+/*--------------------------------------------------------------------*/
+
+#ifdef ATOM_THREADSAFE
+#define _POSIX_C_SOURCE 200112L
+#include <pthread.h>
+#endif
+
+#include "atom.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of buckets of a new table. The count doubles whenever
+   the number of atoms exceeds it, so it is always a power of two. */
+
+static const size_t INITIAL_BUCKET_COUNT = 64;
+
+/*--------------------------------------------------------------------*/
+
+/* Each atom is an Atom header followed directly by the atom's
+   characters and '\0', in one allocation. Atoms in the same bucket are
+   linked to form a list. */
+
+struct Atom
+{
+   /* The hash of the atom's characters. */
+   size_t uHash;
+
+   /* The number of references to the atom. */
+   size_t uRefCount;
+
+   /* The length of the atom, not counting the trailing '\0'. */
+   size_t uLength;
+
+   /* The address of the next Atom in the bucket. */
+   struct Atom *psNextAtom;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The table of all atoms: an array of buckets, or NULL if there are no
+   atoms. */
+
+static struct Atom **ppsBuckets = NULL;
+
+/* The number of buckets in ppsBuckets. */
+
+static size_t uBucketCount = 0;
+
+/* The number of atoms in ppsBuckets. */
+
+static size_t uNumAtoms = 0;
+
+#ifdef ATOM_THREADSAFE
+/* Guards the table and every reference count. */
+
+static pthread_mutex_t sMutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define ATOM_LOCK() ((void)pthread_mutex_lock(&sMutex))
+#define ATOM_UNLOCK() ((void)pthread_mutex_unlock(&sMutex))
+#else
+#define ATOM_LOCK() ((void)0)
+#define ATOM_UNLOCK() ((void)0)
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Return the characters of psAtom. */
+
+static const char *Atom_string(struct Atom *psAtom)
+{
+   assert(psAtom != NULL);
+
+   return (const char*)(psAtom + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the header of atom pcAtom. */
+
+static struct Atom *Atom_header(const char *pcAtom)
+{
+   assert(pcAtom != NULL);
+
+   return (struct Atom*)pcAtom - 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a hash code for the uLength characters at pcStr. */
+
+static size_t Atom_hash(const char *pcStr, size_t uLength)
+{
+   const size_t HASH_MULTIPLIER = 65599;
+   size_t u;
+   size_t uHash = 0;
+
+   assert(pcStr != NULL);
+
+   for (u = 0; u < uLength; u++)
+      uHash = uHash * HASH_MULTIPLIER + (size_t)pcStr[u];
+
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Double the number of buckets of the table. Leave the table
+   unchanged if insufficient memory is available, as it is still valid
+   at its current size. */
+
+static void Atom_expand(void)
+{
+   struct Atom **ppsNewBuckets;
+   struct Atom *psAtom;
+   struct Atom *psNextAtom;
+   size_t uNewCount = 2 * uBucketCount;
+   size_t u;
+
+   ppsNewBuckets = (struct Atom**)
+      calloc(uNewCount, sizeof(struct Atom*));
+   if (ppsNewBuckets == NULL)
+      return;
+
+   for (u = 0; u < uBucketCount; u++)
+      for (psAtom = ppsBuckets[u]; psAtom != NULL; psAtom = psNextAtom)
+      {
+         psNextAtom = psAtom->psNextAtom;
+         psAtom->psNextAtom =
+            ppsNewBuckets[psAtom->uHash & (uNewCount - 1)];
+         ppsNewBuckets[psAtom->uHash & (uNewCount - 1)] = psAtom;
+      }
+
+   free(ppsBuckets);
+   ppsBuckets = ppsNewBuckets;
+   uBucketCount = uNewCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the atom for the uLength characters at pcStr, adding it to
+   the table with no references if it is not there, or NULL if
+   insufficient memory is available. The caller must hold the lock. */
+
+static struct Atom *Atom_find(const char *pcStr, size_t uLength)
+{
+   struct Atom *psAtom;
+   size_t uHash;
+   size_t uBucket;
+
+   assert(pcStr != NULL);
+
+   if (ppsBuckets == NULL)
+   {
+      ppsBuckets = (struct Atom**)
+         calloc(INITIAL_BUCKET_COUNT, sizeof(struct Atom*));
+      if (ppsBuckets == NULL)
+         return NULL;
+      uBucketCount = INITIAL_BUCKET_COUNT;
+   }
+
+   uHash = Atom_hash(pcStr, uLength);
+   for (psAtom = ppsBuckets[uHash & (uBucketCount - 1)];
+        psAtom != NULL;
+        psAtom = psAtom->psNextAtom)
+      if (psAtom->uHash == uHash && psAtom->uLength == uLength &&
+          memcmp(Atom_string(psAtom), pcStr, uLength) == 0)
+         return psAtom;
+
+   psAtom = (struct Atom*)
+      malloc(sizeof(struct Atom) + uLength + 1);
+   if (psAtom == NULL)
+   {
+      if (uNumAtoms == 0)
+      {
+         free(ppsBuckets);
+         ppsBuckets = NULL;
+         uBucketCount = 0;
+      }
+      return NULL;
+   }
+   memcpy((char*)Atom_string(psAtom), pcStr, uLength);
+   ((char*)Atom_string(psAtom))[uLength] = '\0';
+   psAtom->uHash = uHash;
+   psAtom->uRefCount = 0;
+   psAtom->uLength = uLength;
+
+   if (uNumAtoms == uBucketCount)
+      Atom_expand();
+
+   uBucket = uHash & (uBucketCount - 1);
+   psAtom->psNextAtom = ppsBuckets[uBucket];
+   ppsBuckets[uBucket] = psAtom;
+   uNumAtoms++;
+
+   return psAtom;
+}
+
+/*--------------------------------------------------------------------*/
+
+const char *Atom_new(const char *pcStr, size_t uLength)
+{
+   struct Atom *psAtom;
+
+   assert(pcStr != NULL);
+
+   ATOM_LOCK();
+   psAtom = Atom_find(pcStr, uLength);
+   if (psAtom != NULL)
+      psAtom->uRefCount++;
+   ATOM_UNLOCK();
+
+   if (psAtom == NULL)
+      return NULL;
+   return Atom_string(psAtom);
+}
+
+/*--------------------------------------------------------------------*/
+
+const char *Atom_retain(const char *pcAtom)
+{
+   assert(pcAtom != NULL);
+
+   ATOM_LOCK();
+   Atom_header(pcAtom)->uRefCount++;
+   ATOM_UNLOCK();
+
+   return pcAtom;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Atom_release(const char *pcAtom)
+{
+   struct Atom *psAtom;
+   struct Atom **ppsLink;
+
+   assert(pcAtom != NULL);
+
+   psAtom = Atom_header(pcAtom);
+
+   ATOM_LOCK();
+   assert(psAtom->uRefCount > 0);
+   psAtom->uRefCount--;
+   if (psAtom->uRefCount == 0)
+   {
+      for (ppsLink = &ppsBuckets[psAtom->uHash & (uBucketCount - 1)];
+           *ppsLink != psAtom;
+           ppsLink = &(*ppsLink)->psNextAtom)
+         assert(*ppsLink != NULL);
+      *ppsLink = psAtom->psNextAtom;
+      free(psAtom);
+
+      /* an empty table is freed, so that no memory outlives the
+         strings it was interning */
+      uNumAtoms--;
+      if (uNumAtoms == 0)
+      {
+         free(ppsBuckets);
+         ppsBuckets = NULL;
+         uBucketCount = 0;
+      }
+   }
+   ATOM_UNLOCK();
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Atom_getLength(const char *pcAtom)
+{
+   assert(pcAtom != NULL);
+
+   return Atom_header(pcAtom)->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Atom_getCount(void)
+{
+   size_t uCount;
+
+   ATOM_LOCK();
+   uCount = uNumAtoms;
+   ATOM_UNLOCK();
+
+   return uCount;
+}
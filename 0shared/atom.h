@@ -0,0 +1,55 @@
+/*--------------------------------------------------------------------*/
+/* atom.h                                                             */
+/* Author: John Matters, Daniel Wang                                  */
+/*--------------------------------------------------------------------*/
+
+#ifndef ATOM_INCLUDED
+#define ATOM_INCLUDED
+
+#include <stddef.h>
+
+/* An atom is a string interned in a single table shared by the whole
+   program, so that equal atoms are the same pointer and each distinct
+   string is stored once however many times it is used. Atoms are
+   reference counted; an atom's string is freed when its last
+   reference is released. The table is created on first use and freed
+   when it becomes empty.
+
+   The table is only safe to use from several threads at once if this
+   module is compiled with ATOM_THREADSAFE defined, in which case every
+   operation takes a mutex. */
+
+/*--------------------------------------------------------------------*/
+
+/* Return the atom for the uLength characters at pcStr, which need not
+   be '\0'-terminated and must not contain '\0', adding a reference to
+   it. Return NULL if insufficient memory is available. */
+
+const char *Atom_new(const char *pcStr, size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Add a reference to pcAtom and return it. */
+
+const char *Atom_retain(const char *pcAtom);
+
+/*--------------------------------------------------------------------*/
+
+/* Release a reference to pcAtom, freeing it if that was the last. */
+
+void Atom_release(const char *pcAtom);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the length of pcAtom, not counting the trailing '\0'. */
+
+size_t Atom_getLength(const char *pcAtom);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of distinct atoms in the table, each of which has
+   at least one reference. */
+
+size_t Atom_getCount(void);
+
+#endif
@@ -6,6 +6,7 @@
 #include "dynarray.h"
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*--------------------------------------------------------------------*/
 
@@ -13,6 +14,11 @@
 
 static const size_t MIN_PHYS_LENGTH = 2;
 
+/* The length of the longest range that DynArray_sort sorts by
+   insertion rather than by partitioning it further. */
+
+static const size_t INSERTION_SORT_LENGTH = 16;
+
 /*--------------------------------------------------------------------*/
 
 /* A DynArray consists of an array, along with its logical and
@@ -51,32 +57,82 @@ static int DynArray_isValid(DynArray_T oDynArray)
 
 /*--------------------------------------------------------------------*/
 
-/* Increase the physical length of oDynArray.  Return 1 (TRUE) if
-   successful and 0 (FALSE) if insufficient memory is available. */
+/* The factor by which the physical length of a full DynArray object
+   grows. */
 
-static int DynArray_grow(DynArray_T oDynArray)
-{
-   const size_t GROWTH_FACTOR = 2;
+static const size_t GROWTH_FACTOR = 2;
 
-   size_t uNewLength;
+/*--------------------------------------------------------------------*/
+
+/* Change the physical length of oDynArray to exactly uPhysLength,
+   which must be at least its length and MIN_PHYS_LENGTH.  Return 1
+   (TRUE) if successful and 0 (FALSE) if insufficient memory is
+   available, in which case oDynArray is unchanged. */
+
+static int DynArray_resize(DynArray_T oDynArray, size_t uPhysLength)
+{
    const void **ppvNewArray;
 
    assert(oDynArray != NULL);
-
-   uNewLength = GROWTH_FACTOR * oDynArray->uPhysLength;
+   assert(uPhysLength >= oDynArray->uLength);
+   assert(uPhysLength >= MIN_PHYS_LENGTH);
 
    ppvNewArray = (const void**)
-      realloc(oDynArray->ppvArray, sizeof(void*) * uNewLength);
+      realloc(oDynArray->ppvArray, sizeof(void*) * uPhysLength);
    if (ppvNewArray == NULL)
       return 0;
 
-   oDynArray->uPhysLength = uNewLength;
+   oDynArray->uPhysLength = uPhysLength;
    oDynArray->ppvArray = ppvNewArray;
    return 1;
 }
 
 /*--------------------------------------------------------------------*/
 
+/* Increase the physical length of oDynArray so that it can hold
+   uCount more elements, by at least GROWTH_FACTOR so that a run of
+   additions takes amortized constant time each.  Return 1 (TRUE) if
+   successful and 0 (FALSE) if insufficient memory is available. */
+
+static int DynArray_grow(DynArray_T oDynArray, size_t uCount)
+{
+   size_t uNewLength;
+
+   assert(oDynArray != NULL);
+
+   uNewLength = GROWTH_FACTOR * oDynArray->uPhysLength;
+   if (uNewLength < oDynArray->uLength + uCount)
+      uNewLength = oDynArray->uLength + uCount;
+
+   return DynArray_resize(oDynArray, uNewLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Halve the physical length of oDynArray, as many times as needed,
+   while its elements would fill no more than a quarter of it. The gap
+   between the quarter at which it shrinks and the half at which it
+   is left keeps alternating additions and removals from reallocating
+   each time. If the smaller array cannot be had, the larger one still
+   works, so oDynArray is left as it is. */
+
+static void DynArray_shrink(DynArray_T oDynArray)
+{
+   size_t uNewLength;
+
+   assert(oDynArray != NULL);
+
+   uNewLength = oDynArray->uPhysLength;
+   while (oDynArray->uLength <= uNewLength / 4 &&
+          uNewLength / 2 >= MIN_PHYS_LENGTH)
+      uNewLength /= 2;
+
+   if (uNewLength < oDynArray->uPhysLength)
+      (void)DynArray_resize(oDynArray, uNewLength);
+}
+
+/*--------------------------------------------------------------------*/
+
 DynArray_T DynArray_new(size_t uLength)
 {
    DynArray_T oDynArray;
@@ -161,7 +217,7 @@ int DynArray_add(DynArray_T oDynArray, const void *pvElement)
    assert(DynArray_isValid(oDynArray));
 
    if (oDynArray->uLength == oDynArray->uPhysLength)
-      if (! DynArray_grow(oDynArray))
+      if (! DynArray_grow(oDynArray, 1))
          return 0;
 
    oDynArray->ppvArray[oDynArray->uLength] = pvElement;
@@ -177,21 +233,53 @@ int DynArray_add(DynArray_T oDynArray, const void *pvElement)
 int DynArray_addAt(DynArray_T oDynArray, size_t uIndex,
                    const void *pvElement)
 {
-   size_t u;
+   assert(oDynArray != NULL);
+   assert(uIndex <= oDynArray->uLength);
+   assert(DynArray_isValid(oDynArray));
 
+   /* a single element is a run of one */
+   return DynArray_addRangeAt(oDynArray, uIndex, (void**)&pvElement, 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex)
+{
+   const void *pvOldElement;
+
+   assert(oDynArray != NULL);
+   assert(uIndex < oDynArray->uLength);
+   assert(DynArray_isValid(oDynArray));
+
+   pvOldElement = oDynArray->ppvArray[uIndex];
+   DynArray_removeRange(oDynArray, uIndex, 1);
+
+   return (void*)pvOldElement;
+}
+
+/*--------------------------------------------------------------------*/
+
+int DynArray_addRangeAt(DynArray_T oDynArray, size_t uIndex,
+                        void **ppvElements, size_t uCount)
+{
    assert(oDynArray != NULL);
    assert(uIndex <= oDynArray->uLength);
+   assert(ppvElements != NULL || uCount == 0);
    assert(DynArray_isValid(oDynArray));
 
-   if (oDynArray->uLength == oDynArray->uPhysLength)
-      if (! DynArray_grow(oDynArray))
+   if (uCount == 0)
+      return 1;
+
+   if (uCount > oDynArray->uPhysLength - oDynArray->uLength)
+      if (! DynArray_grow(oDynArray, uCount))
          return 0;
 
-   for (u = oDynArray->uLength; u > uIndex; u--)
-      oDynArray->ppvArray[u] = oDynArray->ppvArray[u-1];
-
-   oDynArray->ppvArray[uIndex] = pvElement;
-   oDynArray->uLength++;
+   memmove(&oDynArray->ppvArray[uIndex + uCount],
+           &oDynArray->ppvArray[uIndex],
+           sizeof(void*) * (oDynArray->uLength - uIndex));
+   memcpy(&oDynArray->ppvArray[uIndex], ppvElements,
+          sizeof(void*) * uCount);
+   oDynArray->uLength += uCount;
 
    assert(DynArray_isValid(oDynArray));
 
@@ -200,39 +288,67 @@ int DynArray_addAt(DynArray_T oDynArray, size_t uIndex,
 
 /*--------------------------------------------------------------------*/
 
-void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex)
+void DynArray_removeRange(DynArray_T oDynArray, size_t uIndex,
+                          size_t uCount)
 {
-   const void *pvOldElement;
-   size_t u;
+   assert(oDynArray != NULL);
+   assert(uIndex <= oDynArray->uLength);
+   assert(uCount <= oDynArray->uLength - uIndex);
+   assert(DynArray_isValid(oDynArray));
 
+   oDynArray->uLength -= uCount;
+
+   memmove(&oDynArray->ppvArray[uIndex],
+           &oDynArray->ppvArray[uIndex + uCount],
+           sizeof(void*) * (oDynArray->uLength - uIndex));
+   DynArray_shrink(oDynArray);
+
+   assert(DynArray_isValid(oDynArray));
+}
+
+/*--------------------------------------------------------------------*/
+
+int DynArray_reserve(DynArray_T oDynArray, size_t uPhysLength)
+{
    assert(oDynArray != NULL);
-   assert(uIndex < oDynArray->uLength);
    assert(DynArray_isValid(oDynArray));
 
-   pvOldElement = oDynArray->ppvArray[uIndex];
+   if (uPhysLength <= oDynArray->uPhysLength)
+      return 1;
 
-   oDynArray->uLength--;
+   return DynArray_resize(oDynArray, uPhysLength);
+}
 
-   for (u = uIndex; u < oDynArray->uLength; u++)
-      oDynArray->ppvArray[u] = oDynArray->ppvArray[u+1];
+/*--------------------------------------------------------------------*/
+
+void DynArray_shrinkToFit(DynArray_T oDynArray)
+{
+   size_t uPhysLength;
 
+   assert(oDynArray != NULL);
    assert(DynArray_isValid(oDynArray));
 
-   return (void*)pvOldElement;
+   uPhysLength = oDynArray->uLength;
+   if (uPhysLength < MIN_PHYS_LENGTH)
+      uPhysLength = MIN_PHYS_LENGTH;
+
+   /* if the smaller array cannot be had, the larger one still works */
+   if (uPhysLength < oDynArray->uPhysLength)
+      (void)DynArray_resize(oDynArray, uPhysLength);
+
+   assert(DynArray_isValid(oDynArray));
 }
 
 /*--------------------------------------------------------------------*/
 
 void DynArray_toArray(DynArray_T oDynArray, void **ppvArray)
 {
-   size_t u;
-
    assert(oDynArray != NULL);
    assert(ppvArray != NULL);
    assert(DynArray_isValid(oDynArray));
 
-   for (u = 0; u < oDynArray->uLength; u++)
-      ppvArray[u] = (void*)oDynArray->ppvArray[u];
+   memcpy(ppvArray, oDynArray->ppvArray,
+          sizeof(void*) * oDynArray->uLength);
 }
 
 /*--------------------------------------------------------------------*/
@@ -253,60 +369,191 @@ void DynArray_map(DynArray_T oDynArray,
 
 /*--------------------------------------------------------------------*/
 
-/* Sort the array of elements that resides in memory at
-   addresses ppvLo...ppvHi in ascending order, as determined
-   by *pfCompare.
+/* Sort the uCount elements at ppvElements in ascending order, as
+   determined by *pfCompare, by inserting each into the sorted ones
+   before it. This beats partitioning for short ranges. */
+
+static void DynArray_insertionSort(
+   const void **ppvElements,
+   size_t uCount,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+{
+   const void *pvElement;
+   size_t u;
+   size_t v;
+
+   assert(ppvElements != NULL);
+   assert(pfCompare != NULL);
+
+   for (u = 1; u < uCount; u++)
+   {
+      pvElement = ppvElements[u];
+      for (v = u;
+           v > 0 && (*pfCompare)(pvElement, ppvElements[v - 1]) < 0;
+           v--)
+         ppvElements[v] = ppvElements[v - 1];
+      ppvElements[v] = pvElement;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Restore the heap order of the uCount elements at ppvElements, a
+   max-heap as determined by *pfCompare except perhaps at index uRoot,
+   by moving the element at uRoot down. */
+
+static void DynArray_siftDown(
+   const void **ppvElements,
+   size_t uRoot,
+   size_t uCount,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+{
+   const void *pvElement;
+   size_t uChild;
+
+   assert(ppvElements != NULL);
+   assert(pfCompare != NULL);
+
+   pvElement = ppvElements[uRoot];
+   while ((uChild = 2 * uRoot + 1) < uCount)
+   {
+      if (uChild + 1 < uCount &&
+          (*pfCompare)(ppvElements[uChild],
+                       ppvElements[uChild + 1]) < 0)
+         uChild++;
+      if ((*pfCompare)(pvElement, ppvElements[uChild]) >= 0)
+         break;
+      ppvElements[uRoot] = ppvElements[uChild];
+      uRoot = uChild;
+   }
+   ppvElements[uRoot] = pvElement;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the uCount elements at ppvElements in ascending order, as
+   determined by *pfCompare, by heapsort. */
+
+static void DynArray_heapSort(
+   const void **ppvElements,
+   size_t uCount,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+{
+   const void *pvTemp;
+   size_t u;
+
+   assert(ppvElements != NULL);
+   assert(pfCompare != NULL);
+
+   for (u = uCount / 2; u > 0; u--)
+      DynArray_siftDown(ppvElements, u - 1, uCount, pfCompare);
+   for (u = uCount - 1; u > 0; u--)
+   {
+      pvTemp = ppvElements[0];
+      ppvElements[0] = ppvElements[u];
+      ppvElements[u] = pvTemp;
+      DynArray_siftDown(ppvElements, 0, u, pfCompare);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the uCount elements at ppvElements in ascending order, as
+   determined by *pfCompare, by quicksort, switching to heapsort for
+   any range that takes more than uDepthLimit more partitions.
    *pfCompare must return <0, 0, or >0 depending upon whether
    *pvElement1 is less than, equal to, or greater than *pvElement2,
    respectively. */
 
-static void DynArray_qsort(
-   const void **ppvLo,
-   const void **ppvHi,
+static void DynArray_introsort(
+   const void **ppvElements,
+   size_t uCount,
+   size_t uDepthLimit,
    int (*pfCompare) (const void *pvElement1, const void *pvElement2))
 {
-   /* This function implements a variation of the quicksort algorithm
-      shown in the book "Algorithms + Data Structures = Programs" by
-      Niklaus Wirth. */
+   /* This function implements the introsort of David Musser,
+      "Introspective Sorting and Selection Algorithms". Bounding the
+      partitioning depth keeps it O(n log n) on inputs that would drive
+      a plain quicksort quadratic, such as ones already sorted around
+      its pivot. */
 
-   /* This function uses pointers instead of indices to avoid
-      complications with using unsigned integers as array indices. */
-
-   const void **ppvRight;
-   const void **ppvLeft;
    const void *pvPivot;
    const void *pvTemp;
+   size_t uMid;
+   size_t uLeft;
+   size_t uRight;
 
-   assert(ppvLo != NULL);
-   assert(ppvHi != NULL);
+   assert(ppvElements != NULL);
    assert(pfCompare != NULL);
 
-   ppvRight = ppvLo;
-   ppvLeft = ppvHi;
-   pvPivot = *(ppvLo + ((ppvHi - ppvLo) / 2));
-
-   while (ppvRight <= ppvLeft)
+   while (uCount > INSERTION_SORT_LENGTH)
    {
-      while ((*pfCompare)(*ppvRight, pvPivot) < 0)
-         ppvRight++;
-      while ((*pfCompare)(pvPivot, *ppvLeft) < 0)
-         ppvLeft--;
-      if (ppvRight <= ppvLeft)
+      if (uDepthLimit == 0)
       {
-         /* Swap *ppvRight and *ppvLeft. */
-         pvTemp = *ppvRight;
-         *ppvRight = *ppvLeft;
-         *ppvLeft = pvTemp;
+         DynArray_heapSort(ppvElements, uCount, pfCompare);
+         return;
+      }
+      uDepthLimit--;
 
-         ppvRight++;
-         ppvLeft--;
+      /* Order the first, middle, and last elements, and take the
+         median as the pivot. The first and last then bound both
+         scans below. */
+      uMid = uCount / 2;
+      if ((*pfCompare)(ppvElements[uMid], ppvElements[0]) < 0)
+      {
+         pvTemp = ppvElements[uMid];
+         ppvElements[uMid] = ppvElements[0];
+         ppvElements[0] = pvTemp;
       }
-   }
+      if ((*pfCompare)(ppvElements[uCount - 1], ppvElements[uMid]) < 0)
+      {
+         pvTemp = ppvElements[uCount - 1];
+         ppvElements[uCount - 1] = ppvElements[uMid];
+         ppvElements[uMid] = pvTemp;
+         if ((*pfCompare)(ppvElements[uMid], ppvElements[0]) < 0)
+         {
+            pvTemp = ppvElements[uMid];
+            ppvElements[uMid] = ppvElements[0];
+            ppvElements[0] = pvTemp;
+         }
+      }
+      pvPivot = ppvElements[uMid];
 
-   if (ppvLo < ppvLeft)
-      DynArray_qsort(ppvLo, ppvLeft, pfCompare);
-   if (ppvRight < ppvHi)
-      DynArray_qsort(ppvRight, ppvHi, pfCompare);
+      uLeft = 0;
+      uRight = uCount - 1;
+      for (;;)
+      {
+         while ((*pfCompare)(ppvElements[uLeft], pvPivot) < 0)
+            uLeft++;
+         while ((*pfCompare)(pvPivot, ppvElements[uRight]) < 0)
+            uRight--;
+         if (uLeft >= uRight)
+            break;
+         pvTemp = ppvElements[uLeft];
+         ppvElements[uLeft] = ppvElements[uRight];
+         ppvElements[uRight] = pvTemp;
+         uLeft++;
+         uRight--;
+      }
+
+      /* Recurse into the smaller part and loop on the larger, so the
+         stack grows by at most log2(uCount) frames. */
+      if (uRight + 1 < uCount - uRight - 1)
+      {
+         DynArray_introsort(ppvElements, uRight + 1, uDepthLimit,
+                            pfCompare);
+         ppvElements += uRight + 1;
+         uCount -= uRight + 1;
+      }
+      else
+      {
+         DynArray_introsort(ppvElements + uRight + 1,
+                            uCount - uRight - 1, uDepthLimit,
+                            pfCompare);
+         uCount = uRight + 1;
+      }
+   }
+   DynArray_insertionSort(ppvElements, uCount, pfCompare);
 }
 
 /*--------------------------------------------------------------------*/
@@ -315,17 +562,19 @@ void DynArray_sort(DynArray_T oDynArray,
                    int (*pfCompare)(const void *pvElement1,
                                     const void *pvElement2))
 {
+   size_t uDepthLimit = 0;
+   size_t u;
+
    assert(oDynArray != NULL);
    assert(pfCompare != NULL);
    assert(DynArray_isValid(oDynArray));
 
-   if (oDynArray->uLength < 2)
-      return;
+   /* allow two partitions per halving, as an even split would */
+   for (u = oDynArray->uLength; u > 1; u /= 2)
+      uDepthLimit += 2;
 
-   DynArray_qsort(
-      &oDynArray->ppvArray[0],
-      &oDynArray->ppvArray[oDynArray->uLength-1],
-      pfCompare);
+   DynArray_introsort(oDynArray->ppvArray, oDynArray->uLength,
+                      uDepthLimit, pfCompare);
 
    assert(DynArray_isValid(oDynArray));
 }
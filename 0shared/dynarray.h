@@ -65,12 +65,49 @@ int DynArray_addAt(DynArray_T oDynArray, size_t uIndex,
 
 /*--------------------------------------------------------------------*/
 
-/* Remove and return the uIndex'th element of oDynArray. */
+/* Remove and return the uIndex'th element of oDynArray.  Free about
+   half of the memory for elements once no more than a quarter of it
+   is in use. */
 
 void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex);
 
 /*--------------------------------------------------------------------*/
 
+/* Add the uCount elements of ppvElements to oDynArray such that they
+   are its uIndex'th through (uIndex+uCount-1)'th elements, moving the
+   elements after them in one block.  Return 1 (TRUE) if successful,
+   or 0 (FALSE) if insufficient memory is available, in which case
+   oDynArray is unchanged. */
+
+int DynArray_addRangeAt(DynArray_T oDynArray, size_t uIndex,
+                        void **ppvElements, size_t uCount);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the uCount elements of oDynArray starting with the uIndex'th,
+   moving the elements after them in one block.  Free memory for
+   elements as DynArray_removeAt does. */
+
+void DynArray_removeRange(DynArray_T oDynArray, size_t uIndex,
+                          size_t uCount);
+
+/*--------------------------------------------------------------------*/
+
+/* Make oDynArray able to hold uPhysLength elements without allocating
+   memory, allocating exactly that many if it cannot already.  Return
+   1 (TRUE) if successful, or 0 (FALSE) if insufficient memory is
+   available, in which case oDynArray is unchanged. */
+
+int DynArray_reserve(DynArray_T oDynArray, size_t uPhysLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Free any memory oDynArray holds beyond what its elements need. */
+
+void DynArray_shrinkToFit(DynArray_T oDynArray);
+
+/*--------------------------------------------------------------------*/
+
 /* Fill ppvArray with the elements of oDynArray.  ppvArray must point
    to an area of memory that is large enough to hold all elements of
    oDynArray. */
@@ -92,7 +129,8 @@ void DynArray_map(DynArray_T oDynArray,
 /* Sort oDynArray in the order determined by *pfCompare.
    *pfCompare must return <0, 0, or >0 depending upon whether
    *pvElement1 is less than, equal to, or greater than *pvElement2,
-   respectively. */
+   respectively. The sort is not stable. It takes O(n log n)
+   comparisons for any ordering of the n elements. */
 
 void DynArray_sort(DynArray_T oDynArray,
                    int (*pfCompare)(const void *pvElement1,
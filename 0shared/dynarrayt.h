@@ -0,0 +1,559 @@
+/*--------------------------------------------------------------------*/
+/* dynarrayt.h                                                        */
+/* Author: John Matters, Daniel Wang                                  */
+/*--------------------------------------------------------------------*/
+
+#ifndef DYNARRAYT_INCLUDED
+#define DYNARRAYT_INCLUDED
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* DEFINE_DYNARRAY(NAME, TYPE, CMP) defines NAME_T, a dynamic array
+   whose elements are stored as TYPE values rather than as void
+   pointers, and the functions below to operate on it. Each behaves
+   like the DynArray_T function of the same name (see dynarray.h),
+   except that elements are passed and returned as TYPE.
+
+   CMP(x1, x2) must compare two TYPE elements, returning <0, 0, or >0
+   depending upon whether x1 is less than, equal to, or greater than
+   x2. It may be a function or a macro. Since NAME_sort and
+   NAME_bsearch call it directly rather than through a pointer, the
+   compiler can inline it into their loops.
+
+   The functions are static, so a source file that expands
+   DEFINE_DYNARRAY gets its own copy, and one it does not call costs
+   nothing:
+
+   NAME_T NAME_new(size_t uLength);
+   void NAME_free(NAME_T oArray);
+   size_t NAME_getLength(NAME_T oArray);
+   TYPE NAME_get(NAME_T oArray, size_t uIndex);
+   TYPE NAME_set(NAME_T oArray, size_t uIndex, TYPE xElement);
+   int NAME_add(NAME_T oArray, TYPE xElement);
+   int NAME_addAt(NAME_T oArray, size_t uIndex, TYPE xElement);
+   TYPE NAME_removeAt(NAME_T oArray, size_t uIndex);
+   int NAME_addRangeAt(NAME_T oArray, size_t uIndex, TYPE *pxElements,
+                       size_t uCount);
+   void NAME_removeRange(NAME_T oArray, size_t uIndex, size_t uCount);
+   int NAME_reserve(NAME_T oArray, size_t uPhysLength);
+   void NAME_shrinkToFit(NAME_T oArray);
+   void NAME_sort(NAME_T oArray);
+   void NAME_sortRange(TYPE *pxElements, size_t uCount);
+   int NAME_bsearch(NAME_T oArray, TYPE xSought, size_t *puIndex);
+
+   The elements of a new array are all bits zero. NAME_sortRange sorts
+   the uCount elements of any array pxElements as NAME_sort does. */
+
+/*--------------------------------------------------------------------*/
+
+/* Marks a function that a translation unit need not call, on
+   compilers that would otherwise warn about it. */
+
+#if defined(__GNUC__)
+#define DYNARRAY_UNUSED __attribute__((unused))
+#else
+#define DYNARRAY_UNUSED
+#endif
+
+/* Ranges no longer than this are sorted by insertion, which beats
+   partitioning them further. */
+
+#define DYNARRAY_INSERTION_LENGTH 16
+
+/*--------------------------------------------------------------------*/
+
+#define DEFINE_DYNARRAY(NAME, TYPE, CMP)                              \
+                                                                      \
+typedef struct NAME *NAME##_T;                                        \
+                                                                      \
+struct NAME                                                           \
+{                                                                     \
+   /* The number of elements from the client's point of view. */     \
+   size_t uLength;                                                    \
+                                                                      \
+   /* The number of elements in pxArray. */                           \
+   size_t uPhysLength;                                                \
+                                                                      \
+   /* The array that underlies the NAME. */                           \
+   TYPE *pxArray;                                                     \
+};                                                                    \
+                                                                      \
+static DYNARRAY_UNUSED int NAME##_resize(NAME##_T oArray,             \
+                                         size_t uPhysLength)          \
+{                                                                     \
+   TYPE *pxNewArray;                                                  \
+                                                                      \
+   assert(oArray != NULL);                                            \
+   assert(uPhysLength >= oArray->uLength && uPhysLength >= 2);        \
+                                                                      \
+   pxNewArray =                                                       \
+      (TYPE*)realloc(oArray->pxArray, uPhysLength * sizeof(TYPE));    \
+   if (pxNewArray == NULL)                                            \
+      return 0;                                                       \
+   oArray->uPhysLength = uPhysLength;                                 \
+   oArray->pxArray = pxNewArray;                                      \
+   return 1;                                                          \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED int NAME##_grow(NAME##_T oArray,               \
+                                       size_t uCount)                 \
+{                                                                     \
+   size_t uNewLength;                                                 \
+                                                                      \
+   assert(oArray != NULL);                                            \
+                                                                      \
+   uNewLength = 2 * oArray->uPhysLength;                              \
+   if (uNewLength < oArray->uLength + uCount)                         \
+      uNewLength = oArray->uLength + uCount;                          \
+   return NAME##_resize(oArray, uNewLength);                          \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_shrink(NAME##_T oArray)            \
+{                                                                     \
+   /* the hysteresis of DynArray_shrink */                            \
+   size_t uNewLength;                                                 \
+                                                                      \
+   assert(oArray != NULL);                                            \
+                                                                      \
+   uNewLength = oArray->uPhysLength;                                  \
+   while (oArray->uLength <= uNewLength / 4 && uNewLength / 2 >= 2)   \
+      uNewLength /= 2;                                                \
+   if (uNewLength < oArray->uPhysLength)                              \
+      (void)NAME##_resize(oArray, uNewLength);                        \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED NAME##_T NAME##_new(size_t uLength)            \
+{                                                                     \
+   NAME##_T oArray;                                                   \
+                                                                      \
+   oArray = (NAME##_T)malloc(sizeof(struct NAME));                    \
+   if (oArray == NULL)                                                \
+      return NULL;                                                    \
+                                                                      \
+   oArray->uLength = uLength;                                         \
+   oArray->uPhysLength = uLength < 2 ? 2 : uLength;                   \
+   oArray->pxArray =                                                  \
+      (TYPE*)calloc(oArray->uPhysLength, sizeof(TYPE));               \
+   if (oArray->pxArray == NULL)                                       \
+   {                                                                  \
+      free(oArray);                                                   \
+      return NULL;                                                    \
+   }                                                                  \
+   return oArray;                                                     \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_free(NAME##_T oArray)              \
+{                                                                     \
+   if (oArray == NULL)                                                \
+      return;                                                         \
+   free(oArray->pxArray);                                             \
+   free(oArray);                                                      \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED size_t NAME##_getLength(NAME##_T oArray)       \
+{                                                                     \
+   assert(oArray != NULL);                                            \
+                                                                      \
+   return oArray->uLength;                                            \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED TYPE NAME##_get(NAME##_T oArray,               \
+                                       size_t uIndex)                 \
+{                                                                     \
+   assert(oArray != NULL);                                            \
+   assert(uIndex < oArray->uLength);                                  \
+                                                                      \
+   return oArray->pxArray[uIndex];                                    \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED TYPE NAME##_set(NAME##_T oArray,               \
+                                       size_t uIndex, TYPE xElement)  \
+{                                                                     \
+   TYPE xOldElement;                                                  \
+                                                                      \
+   assert(oArray != NULL);                                            \
+   assert(uIndex < oArray->uLength);                                  \
+                                                                      \
+   xOldElement = oArray->pxArray[uIndex];                             \
+   oArray->pxArray[uIndex] = xElement;                                \
+   return xOldElement;                                                \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED int NAME##_add(NAME##_T oArray, TYPE xElement) \
+{                                                                     \
+   assert(oArray != NULL);                                            \
+                                                                      \
+   if (oArray->uLength == oArray->uPhysLength)                        \
+      if (! NAME##_grow(oArray, 1))                                   \
+         return 0;                                                    \
+                                                                      \
+   oArray->pxArray[oArray->uLength] = xElement;                       \
+   oArray->uLength++;                                                 \
+   return 1;                                                          \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED int NAME##_addRangeAt(NAME##_T oArray,         \
+                                             size_t uIndex,           \
+                                             TYPE *pxElements,        \
+                                             size_t uCount)           \
+{                                                                     \
+   assert(oArray != NULL);                                            \
+   assert(uIndex <= oArray->uLength);                                 \
+   assert(pxElements != NULL || uCount == 0);                         \
+                                                                      \
+   if (uCount == 0)                                                   \
+      return 1;                                                       \
+   if (uCount > oArray->uPhysLength - oArray->uLength)                \
+      if (! NAME##_grow(oArray, uCount))                              \
+         return 0;                                                    \
+                                                                      \
+   memmove(&oArray->pxArray[uIndex + uCount], &oArray->pxArray[uIndex],\
+           (oArray->uLength - uIndex) * sizeof(TYPE));                \
+   memcpy(&oArray->pxArray[uIndex], pxElements, uCount * sizeof(TYPE));\
+   oArray->uLength += uCount;                                         \
+   return 1;                                                          \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_removeRange(NAME##_T oArray,       \
+                                               size_t uIndex,         \
+                                               size_t uCount)         \
+{                                                                     \
+   assert(oArray != NULL);                                            \
+   assert(uIndex <= oArray->uLength);                                 \
+   assert(uCount <= oArray->uLength - uIndex);                        \
+                                                                      \
+   oArray->uLength -= uCount;                                         \
+   memmove(&oArray->pxArray[uIndex], &oArray->pxArray[uIndex + uCount],\
+           (oArray->uLength - uIndex) * sizeof(TYPE));                \
+   NAME##_shrink(oArray);                                             \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED int NAME##_addAt(NAME##_T oArray,              \
+                                        size_t uIndex, TYPE xElement) \
+{                                                                     \
+   assert(oArray != NULL);                                            \
+   assert(uIndex <= oArray->uLength);                                 \
+                                                                      \
+   return NAME##_addRangeAt(oArray, uIndex, &xElement, 1);            \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED TYPE NAME##_removeAt(NAME##_T oArray,          \
+                                            size_t uIndex)            \
+{                                                                     \
+   TYPE xOldElement;                                                  \
+                                                                      \
+   assert(oArray != NULL);                                            \
+   assert(uIndex < oArray->uLength);                                  \
+                                                                      \
+   xOldElement = oArray->pxArray[uIndex];                             \
+   NAME##_removeRange(oArray, uIndex, 1);                             \
+   return xOldElement;                                                \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED int NAME##_reserve(NAME##_T oArray,            \
+                                          size_t uPhysLength)         \
+{                                                                     \
+   assert(oArray != NULL);                                            \
+                                                                      \
+   if (uPhysLength <= oArray->uPhysLength)                            \
+      return 1;                                                       \
+   return NAME##_resize(oArray, uPhysLength);                         \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_shrinkToFit(NAME##_T oArray)       \
+{                                                                     \
+   size_t uPhysLength;                                                \
+                                                                      \
+   assert(oArray != NULL);                                            \
+                                                                      \
+   uPhysLength = oArray->uLength < 2 ? 2 : oArray->uLength;           \
+   if (uPhysLength < oArray->uPhysLength)                             \
+      (void)NAME##_resize(oArray, uPhysLength);                       \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_insertionSort(TYPE *pxElements,    \
+                                                 size_t uCount)       \
+{                                                                     \
+   TYPE xElement;                                                     \
+   size_t u;                                                          \
+   size_t v;                                                          \
+                                                                      \
+   for (u = 1; u < uCount; u++)                                       \
+   {                                                                  \
+      xElement = pxElements[u];                                       \
+      for (v = u; v > 0 && CMP(xElement, pxElements[v - 1]) < 0; v--) \
+         pxElements[v] = pxElements[v - 1];                           \
+      pxElements[v] = xElement;                                       \
+   }                                                                  \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_siftDown(TYPE *pxElements,         \
+                                            size_t uRoot,             \
+                                            size_t uCount)            \
+{                                                                     \
+   TYPE xElement = pxElements[uRoot];                                 \
+   size_t uChild;                                                     \
+                                                                      \
+   while ((uChild = 2 * uRoot + 1) < uCount)                          \
+   {                                                                  \
+      if (uChild + 1 < uCount &&                                      \
+          CMP(pxElements[uChild], pxElements[uChild + 1]) < 0)        \
+         uChild++;                                                    \
+      if (CMP(xElement, pxElements[uChild]) >= 0)                     \
+         break;                                                       \
+      pxElements[uRoot] = pxElements[uChild];                         \
+      uRoot = uChild;                                                 \
+   }                                                                  \
+   pxElements[uRoot] = xElement;                                      \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_heapSort(TYPE *pxElements,         \
+                                            size_t uCount)            \
+{                                                                     \
+   TYPE xTemp;                                                        \
+   size_t u;                                                          \
+                                                                      \
+   for (u = uCount / 2; u > 0; u--)                                   \
+      NAME##_siftDown(pxElements, u - 1, uCount);                     \
+   for (u = uCount - 1; u > 0; u--)                                   \
+   {                                                                  \
+      xTemp = pxElements[0];                                          \
+      pxElements[0] = pxElements[u];                                  \
+      pxElements[u] = xTemp;                                          \
+      NAME##_siftDown(pxElements, 0, u);                              \
+   }                                                                  \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_introsort(TYPE *pxElements,        \
+                                             size_t uCount,           \
+                                             size_t uDepthLimit)      \
+{                                                                     \
+   /* as DynArray_introsort in dynarray.c */                          \
+   TYPE xPivot;                                                       \
+   TYPE xTemp;                                                        \
+   size_t uMid;                                                       \
+   size_t uLeft;                                                      \
+   size_t uRight;                                                     \
+                                                                      \
+   while (uCount > DYNARRAY_INSERTION_LENGTH)                         \
+   {                                                                  \
+      if (uDepthLimit == 0)                                           \
+      {                                                               \
+         NAME##_heapSort(pxElements, uCount);                         \
+         return;                                                      \
+      }                                                               \
+      uDepthLimit--;                                                  \
+                                                                      \
+      uMid = uCount / 2;                                              \
+      if (CMP(pxElements[uMid], pxElements[0]) < 0)                   \
+      {                                                               \
+         xTemp = pxElements[uMid];                                    \
+         pxElements[uMid] = pxElements[0];                            \
+         pxElements[0] = xTemp;                                       \
+      }                                                               \
+      if (CMP(pxElements[uCount - 1], pxElements[uMid]) < 0)          \
+      {                                                               \
+         xTemp = pxElements[uCount - 1];                              \
+         pxElements[uCount - 1] = pxElements[uMid];                   \
+         pxElements[uMid] = xTemp;                                    \
+         if (CMP(pxElements[uMid], pxElements[0]) < 0)                \
+         {                                                            \
+            xTemp = pxElements[uMid];                                 \
+            pxElements[uMid] = pxElements[0];                         \
+            pxElements[0] = xTemp;                                    \
+         }                                                            \
+      }                                                               \
+      xPivot = pxElements[uMid];                                      \
+                                                                      \
+      uLeft = 0;                                                      \
+      uRight = uCount - 1;                                            \
+      for (;;)                                                        \
+      {                                                               \
+         while (CMP(pxElements[uLeft], xPivot) < 0)                   \
+            uLeft++;                                                  \
+         while (CMP(xPivot, pxElements[uRight]) < 0)                  \
+            uRight--;                                                 \
+         if (uLeft >= uRight)                                         \
+            break;                                                    \
+         xTemp = pxElements[uLeft];                                   \
+         pxElements[uLeft] = pxElements[uRight];                      \
+         pxElements[uRight] = xTemp;                                  \
+         uLeft++;                                                     \
+         uRight--;                                                    \
+      }                                                               \
+                                                                      \
+      if (uRight + 1 < uCount - uRight - 1)                           \
+      {                                                               \
+         NAME##_introsort(pxElements, uRight + 1, uDepthLimit);       \
+         pxElements += uRight + 1;                                    \
+         uCount -= uRight + 1;                                        \
+      }                                                               \
+      else                                                            \
+      {                                                               \
+         NAME##_introsort(pxElements + uRight + 1,                    \
+                          uCount - uRight - 1, uDepthLimit);          \
+         uCount = uRight + 1;                                         \
+      }                                                               \
+   }                                                                  \
+   NAME##_insertionSort(pxElements, uCount);                          \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_sortRange(TYPE *pxElements,        \
+                                             size_t uCount)           \
+{                                                                     \
+   size_t uDepthLimit = 0;                                            \
+   size_t u;                                                          \
+                                                                      \
+   assert(pxElements != NULL || uCount == 0);                         \
+                                                                      \
+   for (u = uCount; u > 1; u /= 2)                                    \
+      uDepthLimit += 2;                                               \
+   NAME##_introsort(pxElements, uCount, uDepthLimit);                 \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_sort(NAME##_T oArray)              \
+{                                                                     \
+   assert(oArray != NULL);                                            \
+                                                                      \
+   NAME##_sortRange(oArray->pxArray, oArray->uLength);                \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED int NAME##_bsearch(NAME##_T oArray,            \
+                                          TYPE xSought,               \
+                                          size_t *puIndex)            \
+{                                                                     \
+   size_t uLo;                                                        \
+   size_t uHi;                                                        \
+   size_t uMid;                                                       \
+   int iCompare;                                                      \
+                                                                      \
+   assert(oArray != NULL);                                            \
+   assert(puIndex != NULL);                                           \
+                                                                      \
+   /* a match, if there is one, lies in [uLo, uHi) */                 \
+   uLo = 0;                                                           \
+   uHi = oArray->uLength;                                             \
+   while (uLo < uHi)                                                  \
+   {                                                                  \
+      uMid = uLo + (uHi - uLo) / 2;                                   \
+      iCompare = CMP(oArray->pxArray[uMid], xSought);                 \
+      if (iCompare < 0)                                               \
+         uLo = uMid + 1;                                              \
+      else if (iCompare > 0)                                          \
+         uHi = uMid;                                                  \
+      else                                                            \
+      {                                                               \
+         *puIndex = uMid;                                             \
+         return 1;                                                    \
+      }                                                               \
+   }                                                                  \
+   *puIndex = uLo;                                                    \
+   return 0;                                                          \
+}
+
+/*--------------------------------------------------------------------*/
+
+/* DEFINE_DYNARRAY_KEYSORT(NAME, TYPE, KEY, RANK) adds to NAME_T, which
+   DEFINE_DYNARRAY(NAME, TYPE, CMP) must already have defined, a
+   multikey radix sort for elements ordered by a string key:
+
+   void NAME_sortByKey(NAME_T oArray);
+   void NAME_sortRangeByKey(TYPE *pxElements, size_t uCount);
+
+   KEY(x) must return the '\0'-terminated key of element x, and
+   RANK(c) the rank of character c, with RANK('\0') lower than any
+   other, so that CMP orders elements with different keys as their
+   keys rank character by character. Elements with equal keys are left
+   in CMP's order. Rather than comparing whole keys, each pass
+   partitions the elements by one character of their keys, so a
+   common prefix is read once per element instead of once per
+   comparison. */
+
+#define DEFINE_DYNARRAY_KEYSORT(NAME, TYPE, KEY, RANK)                \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_msdSort(TYPE *pxElements,          \
+                                           size_t uCount,             \
+                                           size_t uDepth)             \
+{                                                                     \
+   TYPE xTemp;                                                        \
+   size_t uLess;                                                      \
+   size_t uGreater;                                                   \
+   size_t u;                                                          \
+   int iPivot;                                                        \
+   int iRank;                                                         \
+   int iRank0;                                                        \
+   int iRank1;                                                        \
+                                                                      \
+   /* the elements all agree on the first uDepth characters of their  \
+      keys, and are partitioned on the next */                        \
+   while (uCount > DYNARRAY_INSERTION_LENGTH)                         \
+   {                                                                  \
+      iRank0 = RANK(KEY(pxElements[0])[uDepth]);                      \
+      iRank1 = RANK(KEY(pxElements[uCount / 2])[uDepth]);             \
+      iPivot = RANK(KEY(pxElements[uCount - 1])[uDepth]);             \
+      if ((iRank0 <= iRank1) == (iRank1 <= iPivot))                   \
+         iPivot = iRank1;                                             \
+      else if ((iRank1 <= iRank0) == (iRank0 <= iPivot))              \
+         iPivot = iRank0;                                             \
+                                                                      \
+      uLess = 0;                                                      \
+      uGreater = uCount;                                              \
+      u = 0;                                                          \
+      while (u < uGreater)                                            \
+      {                                                               \
+         iRank = RANK(KEY(pxElements[u])[uDepth]);                    \
+         if (iRank < iPivot)                                          \
+         {                                                            \
+            xTemp = pxElements[uLess];                                \
+            pxElements[uLess] = pxElements[u];                        \
+            pxElements[u] = xTemp;                                    \
+            uLess++;                                                  \
+            u++;                                                      \
+         }                                                            \
+         else if (iRank > iPivot)                                     \
+         {                                                            \
+            uGreater--;                                               \
+            xTemp = pxElements[uGreater];                             \
+            pxElements[uGreater] = pxElements[u];                     \
+            pxElements[u] = xTemp;                                    \
+         }                                                            \
+         else                                                         \
+            u++;                                                      \
+      }                                                               \
+                                                                      \
+      NAME##_msdSort(pxElements, uLess, uDepth);                      \
+      NAME##_msdSort(pxElements + uGreater, uCount - uGreater, uDepth);\
+                                                                      \
+      /* the middle part's keys agree on one more character, or are   \
+         equal if that character ends them */                         \
+      if (KEY(pxElements[uLess])[uDepth] == '\0')                     \
+      {                                                               \
+         NAME##_sortRange(pxElements + uLess, uGreater - uLess);      \
+         return;                                                      \
+      }                                                               \
+      pxElements += uLess;                                            \
+      uCount = uGreater - uLess;                                      \
+      uDepth++;                                                       \
+   }                                                                  \
+   NAME##_insertionSort(pxElements, uCount);                          \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_sortRangeByKey(TYPE *pxElements,   \
+                                                  size_t uCount)      \
+{                                                                     \
+   assert(pxElements != NULL || uCount == 0);                         \
+                                                                      \
+   NAME##_msdSort(pxElements, uCount, 0);                             \
+}                                                                     \
+                                                                      \
+static DYNARRAY_UNUSED void NAME##_sortByKey(NAME##_T oArray)         \
+{                                                                     \
+   assert(oArray != NULL);                                            \
+                                                                      \
+   NAME##_msdSort(oArray->pxArray, oArray->uLength, 0);               \
+}
+
+#endif
@@ -7,9 +7,14 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "dynarray.h"
+#include "atom.h"
+#include "dynarrayt.h"
 #include "path.h"
 
+/* An array of component atoms, kept as typed elements so that reading
+   a component is a direct array access */
+DEFINE_DYNARRAY(ComponentArray, const char *, strcmp)
+
 /* An absolute path */
 struct path {
    /* The string representation of the path,
@@ -17,18 +22,29 @@ struct path {
    const char *pcPath;
    /* The string length of pcPath */
    size_t ulLength;
-   /* The ordered collection of component strings in the path */
-   DynArray_T oDComponents;
+   /* The ordered collection of component strings in the path, each
+      an atom (see atom.h), so that paths share their components and
+      equal components are equal pointers */
+   ComponentArray_T oDComponents;
+   /* TRUE if Path_relocate moved the path into memory that its
+      caller owns, so that only the components are the path's to
+      free */
+   boolean bRelocated;
 };
 
 /*
-  Frees pcStr. This wrapper is used to match the requirements of the
-  callback function pointer passed to DynArray_map. pvExtra is unused.
+  Releases each component atom of oDComponents and frees it.
 */
-static void Path_freeString(char *pcStr, void *pvExtra) {
-   /* pcStr may be NULL, as this is a no-op to free.
-      pvExtra may be NULL, as it is unused. */
-   free(pcStr);
+static void Path_freeComponents(ComponentArray_T oDComponents) {
+   size_t i;
+
+   assert(oDComponents != NULL);
+
+   /* a component may be NULL if the array was never filled in */
+   for(i = 0; i < ComponentArray_getLength(oDComponents); i++)
+      if(ComponentArray_get(oDComponents, i) != NULL)
+         Atom_release(ComponentArray_get(oDComponents, i));
+   ComponentArray_free(oDComponents);
 }
 
 /*
@@ -41,11 +57,13 @@ static void Path_freeString(char *pcStr, void *pvExtra) {
              or contains consecutive '/' delimiters
   * MEMORY_ERROR if memory could not be allocated to complete request
 */
-static int Path_split(const char *pcPath, DynArray_T *poDComponents) {
+static int Path_split(const char *pcPath,
+                      ComponentArray_T *poDComponents) {
    const char *pcStart = pcPath;
    const char *pcEnd = pcPath;
-   char *pcCopy;
-   DynArray_T oDSubstrings;
+   const char *pcAtom;
+   ComponentArray_T oDSubstrings;
+   size_t ulDepth = 1;
 
    assert(pcPath != NULL);
    assert(poDComponents != NULL);
@@ -56,20 +74,30 @@ static int Path_split(const char *pcPath, DynArray_T *poDComponents) {
       return BAD_PATH;
    }
 
-   oDSubstrings = DynArray_new(0);
+   /* size the array for every component at once, so that it is
+      allocated exactly rather than grown by doubling */
+   for(pcEnd = pcPath; *pcEnd != '\0'; pcEnd++)
+      if(*pcEnd == '/')
+         ulDepth++;
+   pcEnd = pcPath;
+
+   oDSubstrings = ComponentArray_new(0);
    if(oDSubstrings == NULL) {
       *poDComponents = NULL;
       return MEMORY_ERROR;
    }
+   if(!ComponentArray_reserve(oDSubstrings, ulDepth)) {
+      ComponentArray_free(oDSubstrings);
+      *poDComponents = NULL;
+      return MEMORY_ERROR;
+   }
 
    /* validate and split pcPath */
    while(*pcEnd != '\0') {
       pcEnd = pcStart;
       /* component can't start with delimiter */
       if(*pcEnd == '/') {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
+         Path_freeComponents(oDSubstrings);
          *poDComponents = NULL;
          return BAD_PATH;
       }
@@ -80,37 +108,26 @@ static int Path_split(const char *pcPath, DynArray_T *poDComponents) {
 
       /* final component can't end with slash */
       if(*pcEnd == '\0' && *(pcEnd-1) == '/') {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
+         Path_freeComponents(oDSubstrings);
          *poDComponents = NULL;
          return BAD_PATH;
       }
 
-      pcCopy = calloc((size_t)(pcEnd-pcStart+1), sizeof(char));
-      if(pcCopy == NULL) {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
+      pcAtom = Atom_new(pcStart, (size_t)(pcEnd-pcStart));
+      if(pcAtom == NULL) {
+         Path_freeComponents(oDSubstrings);
          *poDComponents = NULL;
          return MEMORY_ERROR;
       }
 
-      if( DynArray_add(oDSubstrings, pcCopy) == 0) {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
+      if( ComponentArray_add(oDSubstrings, pcAtom) == 0) {
+         Atom_release(pcAtom);
+         Path_freeComponents(oDSubstrings);
          *poDComponents = NULL;
          return MEMORY_ERROR;
       }
 
-      while(pcStart != pcEnd) {
-         *pcCopy = *pcStart;
-         pcCopy++;
-         pcStart++;
-      }
-
-      pcStart++;
+      pcStart = pcEnd + 1;
    }
 
    *poDComponents = oDSubstrings;
@@ -156,7 +173,6 @@ int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult) {
    struct path *psNew;
    size_t ulIndex, ulLength, ulSum;
    const char *pcComponent;
-   char *pcCopy;
    char *pcBuild;
    char *pcInsert;
 
@@ -181,7 +197,7 @@ int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult) {
       return MEMORY_ERROR;
    }
 
-   psNew->oDComponents = DynArray_new(ulDepth);
+   psNew->oDComponents = ComponentArray_new(ulDepth);
    if(psNew->oDComponents == NULL) {
       Path_free(psNew);
       *poPResult = NULL;
@@ -199,18 +215,11 @@ int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult) {
    ulSum = 0;
 
    for(ulIndex = 0; ulIndex < ulDepth; ulIndex++) {
-      /* deep copy each component to new DynArray */
+      /* share each component atom with the new array */
       pcComponent = Path_getComponent(oPPath, ulIndex);
-      ulLength = strlen(pcComponent);
-      pcCopy = calloc(ulLength + 1, sizeof(char));
-      if(pcCopy == NULL) {
-         free(pcBuild);
-         Path_free(psNew);
-         *poPResult = NULL;
-         return MEMORY_ERROR;
-      }
-      strcpy(pcCopy, pcComponent);
-      (void) DynArray_set(psNew->oDComponents, ulIndex, pcCopy);
+      ulLength = Atom_getLength(pcComponent);
+      (void) ComponentArray_set(psNew->oDComponents, ulIndex,
+                                Atom_retain(pcComponent));
       /* construct prefix's pathname string */
       strcpy(pcInsert, pcComponent);
       pcInsert[ulLength] = '/';
@@ -243,17 +252,45 @@ int Path_dup(Path_T oPPath, Path_T *poPResult) {
 
 void Path_free(Path_T oPPath) {
    if(oPPath != NULL) {
-      free((char *)oPPath->pcPath);
+      if(oPPath->oDComponents != NULL)
+         Path_freeComponents(oPPath->oDComponents);
 
-      if(oPPath->oDComponents != NULL) {
-         DynArray_map(oPPath->oDComponents,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oPPath->oDComponents);
-      }
+      if(oPPath->bRelocated)
+         return;
+      free((char *)oPPath->pcPath);
    }
    free((struct path*) oPPath);
 }
 
+size_t Path_getRelocatedSize(Path_T oPPath) {
+   assert(oPPath != NULL);
+
+   /* the pathname directly follows the struct */
+   return sizeof(struct path) + oPPath->ulLength + 1;
+}
+
+Path_T Path_relocate(Path_T oPPath, void *pvMemory) {
+   struct path *psNew = pvMemory;
+   char *pcNewPath;
+
+   assert(oPPath != NULL);
+   assert(pvMemory != NULL);
+
+   pcNewPath = (char *) (psNew + 1);
+   memcpy(pcNewPath, oPPath->pcPath, oPPath->ulLength + 1);
+   psNew->pcPath = pcNewPath;
+   psNew->ulLength = oPPath->ulLength;
+   psNew->oDComponents = oPPath->oDComponents;
+   psNew->bRelocated = TRUE;
+
+   /* a path relocated before is in memory its caller frees */
+   if(!oPPath->bRelocated) {
+      free((char *)oPPath->pcPath);
+      free((struct path*) oPPath);
+   }
+   return psNew;
+}
+
 const char *Path_getPathname(Path_T oPPath) {
    assert(oPPath != NULL);
 
@@ -283,7 +320,7 @@ int Path_compareString(Path_T oPPath, const char *pcStr) {
 size_t Path_getDepth(Path_T oPPath) {
    assert(oPPath != NULL);
 
-   return DynArray_getLength(oPPath->oDComponents);
+   return ComponentArray_getLength(oPPath->oDComponents);
 }
 
 size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2) {
@@ -299,8 +336,8 @@ size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2) {
    else
       ulMin = ulDepth2;
    for(i = 0; i < ulMin; i++) {
-      if(strcmp(Path_getComponent(oPPath1, i),
-                Path_getComponent(oPPath2, i)))
+      /* components are atoms, so equal ones are the same pointer */
+      if(Path_getComponent(oPPath1, i) != Path_getComponent(oPPath2, i))
          return i;
    }
    return ulMin;
@@ -312,5 +349,5 @@ const char *Path_getComponent(Path_T oPPath, size_t ulLevel) {
    if(ulLevel >= Path_getDepth(oPPath))
       return NULL;
 
-   return DynArray_get(oPPath->oDComponents, ulLevel);
+   return ComponentArray_get(oPPath->oDComponents, ulLevel);
 }
@@ -46,6 +46,21 @@ int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult);
 /* Destroys and frees all memory allocated for oPPath. */
 void Path_free(Path_T oPPath);
 
+/*
+  Returns the number of bytes Path_relocate needs to hold oPPath.
+*/
+size_t Path_getRelocatedSize(Path_T oPPath);
+
+/*
+  Moves oPPath and its pathname string into the
+  Path_getRelocatedSize(oPPath) bytes at pvMemory, which must be
+  suitably aligned for any object, and returns the moved path, which
+  replaces oPPath. Its components stay where they are. Path_free of
+  the moved path frees its components but not pvMemory, which the
+  caller must keep until then and free itself.
+*/
+Path_T Path_relocate(Path_T oPPath, void *pvMemory);
+
 /* Returns the string representation of the absolute path oPPath. */
 const char *Path_getPathname(Path_T oPPath);
 
@@ -0,0 +1 @@
+../0shared/dynarrayt.h
\ No newline at end of file
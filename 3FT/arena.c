@@ -0,0 +1,299 @@
+/*--------------------------------------------------------------------*/
+/* arena.c                                                            */
+/* Author: John Matters, Daniel Wang                                  */
+/*--------------------------------------------------------------------*/
+
+#ifdef ARENA_HUGEPAGES
+#define _DEFAULT_SOURCE
+#include <sys/mman.h>
+#endif
+
+#include "arena.h"
+#include <assert.h>
+#include <stdlib.h>
+
+/*--------------------------------------------------------------------*/
+
+/* A union of the types with the strictest alignments, whose size is
+   therefore a multiple of any object's alignment. */
+
+union Align
+{
+   long l;
+   double d;
+   long double ld;
+   void *pv;
+   void (*pf)(void);
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The size of a huge page. The chunks of an arena that asks for huge
+   pages are whole numbers of them. */
+
+static const size_t HUGE_PAGE_SIZE = (size_t)2 << 20;
+
+/*--------------------------------------------------------------------*/
+
+/* Each chunk of an arena starts with a Chunk header, padded to a
+   whole number of alignment units, followed by the memory it hands
+   out. Chunks are linked to form a list. */
+
+struct Chunk
+{
+   /* The address of the next Chunk of the arena. */
+   struct Chunk *psNextChunk;
+
+   /* The number of bytes in the chunk, including its header. */
+   size_t uSize;
+
+   /* 1 if the chunk was mapped with mmap, or 0 if it was allocated
+      with malloc. */
+   int iMapped;
+
+   /* 1 if the chunk is backed by huge pages, or 0 if not. */
+   int iHuge;
+};
+
+/* The size of a Chunk header, padded as described above. */
+
+static const size_t CHUNK_HEADER_SIZE =
+   (sizeof(struct Chunk) + sizeof(union Align) - 1) /
+   sizeof(union Align) * sizeof(union Align);
+
+/*--------------------------------------------------------------------*/
+
+/* An Arena is a list of chunks, the most recent of which is partly
+   handed out. */
+
+struct Arena
+{
+   /* The size of a new chunk. */
+   size_t uChunkSize;
+
+   /* The most recently allocated chunk, or NULL if there are none. */
+   struct Chunk *psChunks;
+
+   /* The next byte to hand out from the most recent chunk. */
+   char *pcNext;
+
+   /* The number of bytes left to hand out from the most recent
+      chunk. */
+   size_t uRemaining;
+
+   /* The total size of the chunks. */
+   size_t uSize;
+
+   /* 1 if the arena asks for huge pages, or 0 if not. */
+   int iHuge;
+
+   /* The total size of the chunks backed by huge pages. */
+   size_t uHugeSize;
+};
+
+/*--------------------------------------------------------------------*/
+
+#ifdef ARENA_HUGEPAGES
+/* Map a chunk of uSize bytes, a whole number of huge pages, backed by
+   huge pages if possible: reserved hugetlbfs pages first, and
+   transparent huge pages otherwise. Return the chunk, or NULL if no
+   memory could be mapped. */
+
+static struct Chunk *Arena_mapChunk(size_t uSize)
+{
+   struct Chunk *psChunk;
+   char *pcMap;
+   size_t uHead;
+
+   assert(uSize % HUGE_PAGE_SIZE == 0);
+
+   pcMap = (char*)mmap(NULL, uSize, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                       -1, 0);
+   if (pcMap != (char*)MAP_FAILED)
+   {
+      psChunk = (struct Chunk*)pcMap;
+      psChunk->iHuge = 1;
+      return psChunk;
+   }
+
+   /* transparent huge pages only back aligned huge pages, so map one
+      extra page and trim the mapping to an aligned one */
+   pcMap = (char*)mmap(NULL, uSize + HUGE_PAGE_SIZE,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (pcMap == (char*)MAP_FAILED)
+      return NULL;
+   uHead = (HUGE_PAGE_SIZE - (size_t)pcMap % HUGE_PAGE_SIZE) %
+      HUGE_PAGE_SIZE;
+   if (uHead != 0)
+      (void)munmap(pcMap, uHead);
+   (void)munmap(pcMap + uHead + uSize, HUGE_PAGE_SIZE - uHead);
+
+   psChunk = (struct Chunk*)(pcMap + uHead);
+   psChunk->iHuge =
+      madvise((char*)psChunk, uSize, MADV_HUGEPAGE) == 0;
+   return psChunk;
+}
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Allocate a chunk of uSize bytes for oArena, from huge pages if it
+   asks for them and this module supports them, or from malloc.
+   Return the chunk, or NULL if insufficient memory is available. */
+
+static struct Chunk *Arena_newChunk(Arena_T oArena, size_t uSize)
+{
+   struct Chunk *psChunk;
+
+   assert(oArena != NULL);
+
+#ifdef ARENA_HUGEPAGES
+   if (oArena->iHuge)
+   {
+      psChunk = Arena_mapChunk(uSize);
+      if (psChunk != NULL)
+      {
+         psChunk->uSize = uSize;
+         psChunk->iMapped = 1;
+         return psChunk;
+      }
+   }
+#endif
+
+   psChunk = (struct Chunk*)malloc(uSize);
+   if (psChunk == NULL)
+      return NULL;
+   psChunk->uSize = uSize;
+   psChunk->iMapped = 0;
+   psChunk->iHuge = 0;
+   return psChunk;
+}
+
+/*--------------------------------------------------------------------*/
+
+Arena_T Arena_new(size_t uChunkSize)
+{
+   Arena_T oArena;
+
+   oArena = (struct Arena*)malloc(sizeof(struct Arena));
+   if (oArena == NULL)
+      return NULL;
+
+   oArena->uChunkSize = uChunkSize;
+   oArena->psChunks = NULL;
+   oArena->pcNext = NULL;
+   oArena->uRemaining = 0;
+   oArena->uSize = 0;
+   oArena->iHuge = 0;
+   oArena->uHugeSize = 0;
+
+   return oArena;
+}
+
+/*--------------------------------------------------------------------*/
+
+Arena_T Arena_newHuge(size_t uChunkSize)
+{
+   Arena_T oArena;
+
+   uChunkSize = (uChunkSize + HUGE_PAGE_SIZE - 1) /
+      HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+   if (uChunkSize == 0)
+      uChunkSize = HUGE_PAGE_SIZE;
+
+   oArena = Arena_new(uChunkSize);
+   if (oArena == NULL)
+      return NULL;
+   oArena->iHuge = 1;
+
+   return oArena;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Arena_free(Arena_T oArena)
+{
+   struct Chunk *psChunk;
+   struct Chunk *psNextChunk;
+
+   assert(oArena != NULL);
+
+   for (psChunk = oArena->psChunks; psChunk != NULL;
+        psChunk = psNextChunk)
+   {
+      psNextChunk = psChunk->psNextChunk;
+#ifdef ARENA_HUGEPAGES
+      if (psChunk->iMapped)
+      {
+         (void)munmap((char*)psChunk, psChunk->uSize);
+         continue;
+      }
+#endif
+      free(psChunk);
+   }
+   free(oArena);
+}
+
+/*--------------------------------------------------------------------*/
+
+void *Arena_alloc(Arena_T oArena, size_t uSize)
+{
+   struct Chunk *psChunk;
+   size_t uChunkSize;
+   void *pvResult;
+
+   assert(oArena != NULL);
+
+   /* keep every allocation aligned by rounding up its size */
+   uSize = (uSize + sizeof(union Align) - 1) /
+      sizeof(union Align) * sizeof(union Align);
+
+   if (uSize > oArena->uRemaining)
+   {
+      uChunkSize = oArena->uChunkSize;
+      if (uChunkSize < CHUNK_HEADER_SIZE + uSize)
+      {
+         uChunkSize = CHUNK_HEADER_SIZE + uSize;
+         if (oArena->iHuge)
+            uChunkSize = (uChunkSize + HUGE_PAGE_SIZE - 1) /
+               HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+      }
+      psChunk = Arena_newChunk(oArena, uChunkSize);
+      if (psChunk == NULL)
+         return NULL;
+
+      /* the rest of the previous chunk is abandoned */
+      psChunk->psNextChunk = oArena->psChunks;
+      oArena->psChunks = psChunk;
+      oArena->pcNext = (char*)psChunk + CHUNK_HEADER_SIZE;
+      oArena->uRemaining = uChunkSize - CHUNK_HEADER_SIZE;
+      oArena->uSize += uChunkSize;
+      if (psChunk->iHuge)
+         oArena->uHugeSize += uChunkSize;
+   }
+
+   pvResult = oArena->pcNext;
+   oArena->pcNext += uSize;
+   oArena->uRemaining -= uSize;
+   return pvResult;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Arena_getSize(Arena_T oArena)
+{
+   assert(oArena != NULL);
+
+   return oArena->uSize;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Arena_getHugeSize(Arena_T oArena)
+{
+   assert(oArena != NULL);
+
+   return oArena->uHugeSize;
+}
@@ -0,0 +1,71 @@
+/*--------------------------------------------------------------------*/
+/* arena.h                                                            */
+/* Author: John Matters, Daniel Wang                                  */
+/*--------------------------------------------------------------------*/
+
+#ifndef ARENA_INCLUDED
+#define ARENA_INCLUDED
+
+#include <stddef.h>
+
+/* An Arena_T hands out memory from large chunks in the order it is
+   asked for, so that objects allocated one after another lie next to
+   each other. Memory from an arena cannot be freed piece by piece;
+   it is all freed at once with the arena.
+
+   An arena made with Arena_newHuge asks for its chunks to be backed
+   by huge pages, which cuts the address-translation misses of walking
+   a large structure spread over many ordinary pages. This is only
+   done if this module is compiled with ARENA_HUGEPAGES defined, on a
+   system with mmap and madvise; it uses reserved hugetlbfs pages if
+   there are any, and transparent huge pages otherwise. Chunks that
+   cannot get huge pages come from malloc as usual. */
+
+typedef struct Arena *Arena_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty Arena_T that allocates chunks of uChunkSize
+   bytes, or NULL if insufficient memory is available. */
+
+Arena_T Arena_new(size_t uChunkSize);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty Arena_T that allocates chunks of at least
+   uChunkSize bytes, rounded up to whole huge pages, and backs them
+   with huge pages where it can. Return NULL if insufficient memory is
+   available. */
+
+Arena_T Arena_newHuge(size_t uChunkSize);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oArena and all memory allocated from it. */
+
+void Arena_free(Arena_T oArena);
+
+/*--------------------------------------------------------------------*/
+
+/* Return uSize bytes from oArena, suitably aligned for any object, or
+   NULL if insufficient memory is available. */
+
+void *Arena_alloc(Arena_T oArena, size_t uSize);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes oArena has allocated from the system,
+   including what it has not yet handed out. */
+
+size_t Arena_getSize(Arena_T oArena);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes of oArena's chunks that are backed by
+   huge pages. Chunks given transparent huge pages are counted whole,
+   though the system may still back parts of them with ordinary
+   pages. */
+
+size_t Arena_getHugeSize(Arena_T oArena);
+
+#endif
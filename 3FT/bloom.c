@@ -0,0 +1,172 @@
+/*--------------------------------------------------------------------*/
+/* bloom.c                                                            */
+/* Author: John Matters, Daniel Wang                                  */
+/*--------------------------------------------------------------------*/
+
+#include "bloom.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of counters per string of capacity. Ten counters and
+   seven probes per string give a false positive rate near 1%. */
+
+static const size_t COUNTERS_PER_KEY = 10;
+
+/* The number of counters each string sets. */
+
+static const size_t NUM_PROBES = 7;
+
+/*--------------------------------------------------------------------*/
+
+/* A Bloom is an array of small saturating counters. A counter that
+   reaches UCHAR_MAX stays there, since its true count is no longer
+   known; this only makes the filter slightly less selective. */
+
+struct Bloom
+{
+   /* The number of strings the Bloom was sized for. */
+   size_t uCapacity;
+
+   /* The number of counters. */
+   size_t uNumCounters;
+
+   /* The array of counters. */
+   unsigned char *pucCounters;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Compute two independent hash codes for pcKey in one pass, storing
+   them in *puHash1 and *puHash2. *puHash2 is always odd. The probes
+   of pcKey are then *puHash1 + i * *puHash2 for i = 0, 1, ... */
+
+static void Bloom_hash(const char *pcKey, size_t *puHash1,
+                       size_t *puHash2)
+{
+   const size_t HASH_MULTIPLIER1 = 65599;
+   const size_t HASH_MULTIPLIER2 = 16777619;
+   size_t u;
+   size_t uHash1 = 0;
+   size_t uHash2 = 2166136261U;
+
+   assert(pcKey != NULL);
+   assert(puHash1 != NULL);
+   assert(puHash2 != NULL);
+
+   for (u = 0; pcKey[u] != '\0'; u++)
+   {
+      uHash1 = uHash1 * HASH_MULTIPLIER1 + (size_t)pcKey[u];
+      uHash2 = (uHash2 ^ (unsigned char)pcKey[u]) * HASH_MULTIPLIER2;
+   }
+
+   *puHash1 = uHash1;
+   *puHash2 = uHash2 | 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+Bloom_T Bloom_new(size_t uCapacity)
+{
+   Bloom_T oBloom;
+
+   oBloom = (struct Bloom*)malloc(sizeof(struct Bloom));
+   if (oBloom == NULL)
+      return NULL;
+
+   if (uCapacity < 1)
+      uCapacity = 1;
+   oBloom->uCapacity = uCapacity;
+   oBloom->uNumCounters = uCapacity * COUNTERS_PER_KEY;
+   oBloom->pucCounters = (unsigned char*)
+      calloc(oBloom->uNumCounters, sizeof(unsigned char));
+   if (oBloom->pucCounters == NULL)
+   {
+      free(oBloom);
+      return NULL;
+   }
+
+   return oBloom;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Bloom_free(Bloom_T oBloom)
+{
+   assert(oBloom != NULL);
+
+   free(oBloom->pucCounters);
+   free(oBloom);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Bloom_getCapacity(Bloom_T oBloom)
+{
+   assert(oBloom != NULL);
+
+   return oBloom->uCapacity;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Bloom_add(Bloom_T oBloom, const char *pcKey)
+{
+   size_t uHash1, uHash2;
+   size_t u;
+
+   assert(oBloom != NULL);
+   assert(pcKey != NULL);
+
+   Bloom_hash(pcKey, &uHash1, &uHash2);
+   for (u = 0; u < NUM_PROBES; u++)
+   {
+      unsigned char *pucCounter =
+         &oBloom->pucCounters[(uHash1 + u * uHash2) %
+                              oBloom->uNumCounters];
+      if (*pucCounter != UCHAR_MAX)
+         (*pucCounter)++;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void Bloom_remove(Bloom_T oBloom, const char *pcKey)
+{
+   size_t uHash1, uHash2;
+   size_t u;
+
+   assert(oBloom != NULL);
+   assert(pcKey != NULL);
+
+   Bloom_hash(pcKey, &uHash1, &uHash2);
+   for (u = 0; u < NUM_PROBES; u++)
+   {
+      unsigned char *pucCounter =
+         &oBloom->pucCounters[(uHash1 + u * uHash2) %
+                              oBloom->uNumCounters];
+      assert(*pucCounter != 0);
+      if (*pucCounter != UCHAR_MAX)
+         (*pucCounter)--;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+int Bloom_mayContain(Bloom_T oBloom, const char *pcKey)
+{
+   size_t uHash1, uHash2;
+   size_t u;
+
+   assert(oBloom != NULL);
+   assert(pcKey != NULL);
+
+   Bloom_hash(pcKey, &uHash1, &uHash2);
+   for (u = 0; u < NUM_PROBES; u++)
+      if (oBloom->pucCounters[(uHash1 + u * uHash2) %
+                              oBloom->uNumCounters] == 0)
+         return 0;
+   return 1;
+}
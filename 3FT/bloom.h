@@ -0,0 +1,58 @@
+/*--------------------------------------------------------------------*/
+/* bloom.h                                                            */
+/* Author: John Matters, Daniel Wang                                  */
+/*--------------------------------------------------------------------*/
+
+#ifndef BLOOM_INCLUDED
+#define BLOOM_INCLUDED
+
+#include <stddef.h>
+
+/* A Bloom_T is a counting Bloom filter over strings: a compact,
+   approximate set that may report a string it does not contain, but
+   never fails to report one it does. */
+
+typedef struct Bloom *Bloom_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty Bloom_T sized to hold uCapacity strings with a
+   false positive rate of about one percent, or NULL if insufficient
+   memory is available. */
+
+Bloom_T Bloom_new(size_t uCapacity);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oBloom. */
+
+void Bloom_free(Bloom_T oBloom);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of strings oBloom was sized to hold. Adding more
+   strings than this is allowed, but raises the false positive rate. */
+
+size_t Bloom_getCapacity(Bloom_T oBloom);
+
+/*--------------------------------------------------------------------*/
+
+/* Add pcKey to oBloom. */
+
+void Bloom_add(Bloom_T oBloom, const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove pcKey from oBloom. pcKey must have been added to oBloom at
+   least as many times as it has been removed. */
+
+void Bloom_remove(Bloom_T oBloom, const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Return 0 (FALSE) if pcKey is certainly not in oBloom, and 1 (TRUE)
+   if it may be. */
+
+int Bloom_mayContain(Bloom_T oBloom, const char *pcKey);
+
+#endif
@@ -77,6 +77,20 @@ static boolean CheckerFT_treeCheck(Node_T oNNode, int *pulCount) {
       }
       *pulCount = *pulCount - 1;
 
+      /* A directory with one child must share its chain end with
+         that child, which checks each chain end inductively */
+      if (Node_getNumChildren(oNNode) == 1)
+      {
+         Node_T oNOnly = NULL;
+         Node_getChild(oNNode, 0, &oNOnly);
+         if (Node_getChainEnd(oNNode) != Node_getChainEnd(oNOnly))
+         {
+            fprintf(stderr, "Chain end out of date below (%s)\n",
+                    Path_getPathname(Node_getPath(oNNode)));
+            return FALSE;
+         }
+      }
+
       /* Recur on every child of oNNode */
       for(ulIndex = 0; ulIndex < Node_getNumChildren(oNNode); ulIndex++)
       {
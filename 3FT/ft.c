@@ -5,475 +5,3760 @@
 
 #include <stddef.h>
 #include <assert.h>
+#include <errno.h>
+#include <limits.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "arena.h"
+#include "atom.h"
 #include "dynarray.h"
+#include "dynarrayt.h"
+#include "symtable.h"
+#include "bloom.h"
 #include "path.h"
 #include "nodeFT.h"
 #include "checkerFT.h"
 #include "ft.h"
 
+/* The number of recently resolved directories the FT remembers. */
+enum { DIR_CACHE_LENGTH = 8 };
+/* The number of lookups FT_statMany keeps in progress at once. */
+enum { STAT_GROUP_LENGTH = 8 };
+/* The most components a pattern for FT_glob may have: one less than
+   the bits of the unsigned long that holds a set of match states. */
+enum { GLOB_MAX_COMPONENTS = sizeof(unsigned long) * CHAR_BIT - 1 };
+/* The size of each chunk of memory FT_compact moves nodes into: one
+   huge page, when the arena can get them (see arena.h). */
+enum { COMPACT_CHUNK_SIZE = 2 << 20 };
+/* How many levels ahead a frozen child search prefetches keys: the
+   keys 3 levels below a slot are 8 adjacent ones, one cache line. */
+enum { FROZEN_PREFETCH_SPAN = 8 };
+
+/* Hints that the memory at pv will be read soon, on compilers that
+   can pass the hint on to the processor. */
+#if defined(__GNUC__)
+#define FT_PREFETCH(pv) __builtin_prefetch(pv)
+#else
+#define FT_PREFETCH(pv) ((void) (pv))
+#endif
+
 /* TRUE if the FT is initialized, FALSE otherwise. */
 static boolean bIsInitialized;
 /* Pointer to the root of the FT. */
 static Node_T oNRoot;
 /* Number of nodes in the FT */
 static size_t ulCount;
+/* Index from full pathname to node, or NULL if indexing is off. */
+static SymTable_T oSIndex;
+/* Filter of full pathnames in the FT, or NULL if filtering is off. */
+static Bloom_T oBFilter;
+/* Index from final path component to a NodeList_T of the nodes with
+   that name in tree order, or NULL if name indexing is off. */
+static SymTable_T oSNames;
+/* Recently resolved directories, most recently used first, with any
+   unused slots (which are NULL) at the end. */
+static Node_T aoNDirCache[DIR_CACHE_LENGTH];
+/* The open directory handles, or NULL if there are none. */
+static DynArray_T oDHandles;
+/* The frozen FT (see FT_freeze), or NULL if the FT is not frozen. */
+static struct frozenTree *psFrozen;
+/* The arena that the last complete pass of FT_compact moved nodes
+   into, or NULL if there has been none. */
+static Arena_T oACompacted;
+/* The arena that the pass of FT_compact in progress is moving nodes
+   into, or NULL if no pass is in progress. */
+static Arena_T oACompacting;
+/* The next node, in the order FT_toString lists them, that the pass
+   of FT_compact in progress will move, or NULL if it has reached the
+   end of the FT. */
+static Node_T oNCompactNext;
+
+/* A handle on a directory of the FT, opened by FT_openDir */
+struct dirHandle {
+   /* The directory, or NULL once it has been removed from the FT */
+   Node_T oNDir;
+};
+
+/* A node of a frozen FT */
+struct frozenNode {
+   /* The offset of the node's name in the frozen FT's name pool */
+   size_t ulName;
+   /* TRUE if the node is a file, FALSE if it is a directory */
+   boolean isFile;
+   union {
+      /* A directory's children, which are contiguous and sorted by
+         name */
+      struct {
+         size_t ulFirstChild;
+         size_t ulNumChildren;
+      } sDir;
+      /* A file's contents */
+      struct {
+         void *pvContent;
+         size_t ulSize;
+      } sFile;
+   } u;
+};
+
+/*
+  An FT frozen into a compact read-only form: one array of nodes, in
+  which the root comes first and each directory's children are a
+  contiguous block, and one pool holding every node's name. Each block
+  is in Eytzinger order: slot 1 (the block's first entry) is the
+  median child, and slots 2k and 2k+1 hold the medians of the children
+  before and after slot k's, so a search reads slots that are close
+  together near the top and can prefetch those further down.
+*/
+struct frozenTree {
+   /* The nodes, or NULL if the FT was empty */
+   struct frozenNode *psNodes;
+   /* The prefix keys of the nodes' names, parallel to psNodes (see
+      FT_nameKey), so a search reads names only when keys tie */
+   unsigned long *pulKeys;
+   /* The number of nodes */
+   size_t ulNumNodes;
+   /* The '\0'-terminated names of the nodes, one after another */
+   char *pcNames;
+   /* The length of the longest pathname in the FT */
+   size_t ulMaxPathLength;
+   /* The total length of every pathname, each plus one for a
+      newline, as in FT_toString */
+   size_t ulPathsLength;
+};
 
 /* --------------------------------------------------------------------
 
-  The FT_traversePath and FT_findNode functions modularize the common
-  functionality of going as far as possible down an FT towards a path
-  and returning either the node of however far was reached or the
-  node if the full path was reached, respectively.
+  The following functions maintain the cache of recently resolved
+  directories, which lets a traversal start from the deepest cached
+  ancestor of its path instead of from the root. Repeated operations
+  in the same directory then skip the descent entirely.
 */
 
 /*
-  Traverses the FT starting at the root as far as possible towards
-  absolute path oPPath. If able to traverse, returns an int SUCCESS
-  status and sets *poNFurthest to the furthest node reached (which may
-  be only a prefix of oPPath, or even NULL if the root is NULL).
-  Otherwise, sets *poNFurthest to NULL and returns with status:
-  * CONFLICTING_PATH if the root's path is not a prefix of oPPath
-  * MEMORY_ERROR if memory could not be allocated to complete request
+  Returns TRUE if oPPrefix is oPPath or one of its ancestors' paths,
+  and FALSE otherwise.
 */
-static int FT_traversePath(Path_T oPPath, Node_T *poNFurthest) {
-   int iStatus;
-   Path_T oPPrefix = NULL;
-   Node_T oNCurr;
-   Node_T oNChild = NULL;
-   size_t ulDepth;
-   size_t i;
-   size_t ulChildID = 0;
+static boolean FT_isPrefixPath(Path_T oPPrefix, Path_T oPPath) {
+   const char *pcPath;
+   size_t ulLength;
 
+   assert(oPPrefix != NULL);
    assert(oPPath != NULL);
-   assert(poNFurthest != NULL);
 
-   /* root is NULL -> won't find anything */
-   if(oNRoot == NULL) {
-      *poNFurthest = NULL;
-      return SUCCESS;
+   ulLength = Path_getStrLength(oPPrefix);
+   if(Path_getStrLength(oPPath) < ulLength)
+      return FALSE;
+
+   pcPath = Path_getPathname(oPPath);
+   if(strncmp(Path_getPathname(oPPrefix), pcPath, ulLength))
+      return FALSE;
+   /* the prefix must end on a component boundary */
+   return pcPath[ulLength] == '\0' || pcPath[ulLength] == '/';
+}
+
+/*
+  Returns the rank of character c in tree order: '\0' first, then
+  '/', then everything else in the order of unsigned char.
+*/
+static int FT_rankPathChar(char c) {
+   return (c == '\0') ? 0 : (c == '/') ? 1 : (unsigned char) c + 2;
+}
+
+/*
+  Compares pathnames pcPath1 and pcPath2 component by component, so
+  that every path sorts immediately before its descendants, which
+  sort before its later siblings: that is, lexicographically except
+  that '/' sorts before every other character.
+  Returns <0, 0, or >0 if pcPath1 is "less than", "equal to", or
+  "greater than" pcPath2, respectively.
+*/
+static int FT_comparePathnames(const char *pcPath1,
+                               const char *pcPath2) {
+   assert(pcPath1 != NULL);
+   assert(pcPath2 != NULL);
+
+   while(*pcPath1 != '\0' && *pcPath1 == *pcPath2) {
+      pcPath1++;
+      pcPath2++;
    }
 
-   iStatus = Path_prefix(oPPath, 1, &oPPrefix);
-   if(iStatus != SUCCESS) {
-      *poNFurthest = NULL;
-      return iStatus;
+   return FT_rankPathChar(*pcPath1) - FT_rankPathChar(*pcPath2);
+}
+
+/* Makes directory oNDir the most recently used cache entry. */
+static void FT_rememberDir(Node_T oNDir) {
+   size_t i;
+
+   assert(oNDir != NULL);
+   assert(!Node_isFile(oNDir));
+
+   /* find oNDir's slot, or else evict the least recently used one */
+   for(i = 0; i < DIR_CACHE_LENGTH - 1; i++)
+      if(aoNDirCache[i] == oNDir)
+         break;
+   for(; i > 0; i--)
+      aoNDirCache[i] = aoNDirCache[i - 1];
+   aoNDirCache[0] = oNDir;
+}
+
+/*
+  Returns the deepest cached directory whose path is oPPath or one of
+  its ancestors' paths, or NULL if there is none.
+*/
+static Node_T FT_cachedAncestor(Path_T oPPath) {
+   Node_T oNBest = NULL;
+   size_t ulBestLength = 0;
+   size_t i;
+
+   assert(oPPath != NULL);
+
+   for(i = 0; i < DIR_CACHE_LENGTH && aoNDirCache[i] != NULL; i++) {
+      Path_T oPCached = Node_getPath(aoNDirCache[i]);
+      if(Path_getStrLength(oPCached) > ulBestLength &&
+         FT_isPrefixPath(oPCached, oPPath)) {
+         oNBest = aoNDirCache[i];
+         ulBestLength = Path_getStrLength(oPCached);
+      }
    }
 
-   if(Path_comparePath(Node_getPath(oNRoot), oPPrefix)) {
-      Path_free(oPPrefix);
-      *poNFurthest = NULL;
-      return CONFLICTING_PATH;
+   if(oNBest != NULL)
+      FT_rememberDir(oNBest);
+   return oNBest;
+}
+
+/*
+  Drops every cached directory in the subtree rooted at oNNode, which
+  is about to be freed.
+*/
+static void FT_forgetSubtree(Node_T oNNode) {
+   size_t i;
+   size_t ulKept = 0;
+
+   assert(oNNode != NULL);
+
+   for(i = 0; i < DIR_CACHE_LENGTH && aoNDirCache[i] != NULL; i++)
+      if(!FT_isPrefixPath(Node_getPath(oNNode),
+                          Node_getPath(aoNDirCache[i])))
+         aoNDirCache[ulKept++] = aoNDirCache[i];
+   for(; ulKept < DIR_CACHE_LENGTH; ulKept++)
+      aoNDirCache[ulKept] = NULL;
+}
+
+/*
+  Invalidates every open handle on a directory in the subtree rooted
+  at oNNode, which is about to be freed.
+*/
+static void FT_invalidateHandles(Node_T oNNode) {
+   size_t i;
+
+   assert(oNNode != NULL);
+
+   if(oDHandles == NULL)
+      return;
+
+   for(i = 0; i < DynArray_getLength(oDHandles); i++) {
+      FTDir_T oDDir = DynArray_get(oDHandles, i);
+      if(oDDir->oNDir != NULL &&
+         FT_isPrefixPath(Node_getPath(oNNode),
+                         Node_getPath(oDDir->oNDir)))
+         oDDir->oNDir = NULL;
    }
-   Path_free(oPPrefix);
-   oPPrefix = NULL;
+}
 
-   oNCurr = oNRoot;
-   ulDepth = Path_getDepth(oPPath);
-   for(i = 2; i <= ulDepth; i++) {
-      iStatus = Path_prefix(oPPath, i, &oPPrefix);
-      if(iStatus != SUCCESS) {
-         *poNFurthest = NULL;
-         return iStatus;
+/* --------------------------------------------------------------------
+
+  The following functions keep the optional full-path index, negative
+  lookup filter, and name index in sync with the nodes of the FT.
+  Every node of the FT has a binding from its pathname in oSIndex
+  whenever oSIndex is not NULL, its pathname is in oBFilter whenever
+  oBFilter is not NULL, and it is listed under its name in oSNames
+  whenever oSNames is not NULL.
+*/
+
+/*
+  Compares nodes oNNode1 and oNNode2 by their paths' tree order, as in
+  FT_comparePathnames, which keeps each list of oSNames in the order
+  FT_findByName reports it.
+*/
+static int FT_compareNodePaths(Node_T oNNode1, Node_T oNNode2) {
+   assert(oNNode1 != NULL);
+   assert(oNNode2 != NULL);
+
+   return FT_comparePathnames(Path_getPathname(Node_getPath(oNNode1)),
+                              Path_getPathname(Node_getPath(oNNode2)));
+}
+
+/* A list of nodes in oSNames, whose searches call FT_compareNodePaths
+   directly */
+DEFINE_DYNARRAY(NodeList, Node_T, FT_compareNodePaths)
+
+/*
+  Lists oNNode in oSNames under its name. Returns TRUE if successful,
+  or FALSE if memory could not be allocated, leaving oSNames
+  unchanged.
+*/
+static boolean FT_addName(Node_T oNNode) {
+   NodeList_T oDNodes;
+   size_t ulIndex = 0;
+
+   assert(oNNode != NULL);
+   assert(oSNames != NULL);
+
+   oDNodes = SymTable_get(oSNames, Node_getName(oNNode));
+   if(oDNodes == NULL) {
+      oDNodes = NodeList_new(0);
+      if(oDNodes == NULL)
+         return FALSE;
+      if(!SymTable_put(oSNames, Node_getName(oNNode), oDNodes)) {
+         NodeList_free(oDNodes);
+         return FALSE;
       }
-      if(Node_hasChild(oNCurr, oPPrefix, &ulChildID)) {
-         /* go to that child and continue with next prefix */
-         Path_free(oPPrefix);
-         oPPrefix = NULL;
-         iStatus = Node_getChild(oNCurr, ulChildID, &oNChild);
-         if(iStatus != SUCCESS) {
-            *poNFurthest = NULL;
-            return iStatus;
-         }
-         oNCurr = oNChild;
+   }
+
+   /* a list is kept sorted, so finding a node in it is a bisection */
+   (void) NodeList_bsearch(oDNodes, oNNode, &ulIndex);
+   if(!NodeList_addAt(oDNodes, ulIndex, oNNode)) {
+      if(NodeList_getLength(oDNodes) == 0) {
+         (void) SymTable_remove(oSNames, Node_getName(oNNode));
+         NodeList_free(oDNodes);
       }
-      else {
-         /* oNCurr doesn't have child with path oPPrefix:
-            this is as far as we can go */
+      return FALSE;
+   }
+   return TRUE;
+}
+
+/*
+  Removes oNNode from oSNames, if it is listed there, along with the
+  nodes of its subtree that have the same name, as the subtree is
+  being removed. Those follow it in its list as one run, in tree
+  order, so they are all removed at once.
+*/
+static void FT_removeName(Node_T oNNode) {
+   NodeList_T oDNodes;
+   size_t ulIndex = 0;
+   size_t ulEnd;
+
+   assert(oNNode != NULL);
+   assert(oSNames != NULL);
+
+   oDNodes = SymTable_get(oSNames, Node_getName(oNNode));
+   if(oDNodes == NULL || !NodeList_bsearch(oDNodes, oNNode, &ulIndex))
+      return;
+
+   for(ulEnd = ulIndex + 1; ulEnd < NodeList_getLength(oDNodes);
+       ulEnd++)
+      if(!FT_isPrefixPath(Node_getPath(oNNode),
+                          Node_getPath(NodeList_get(oDNodes, ulEnd))))
          break;
-      }
+   NodeList_removeRange(oDNodes, ulIndex, ulEnd - ulIndex);
+   if(NodeList_getLength(oDNodes) == 0) {
+      (void) SymTable_remove(oSNames, Node_getName(oNNode));
+      NodeList_free(oDNodes);
    }
+}
 
-   Path_free(oPPrefix);
-   *poNFurthest = oNCurr;
-   return SUCCESS;
+/*
+  Lists every node in the subtree rooted at oNNode in oSNames. Returns
+  TRUE if successful, or FALSE if memory could not be allocated, in
+  which case some of the nodes may have been listed.
+*/
+static boolean FT_nameSubtree(Node_T oNNode) {
+   size_t c;
+
+   assert(oNNode != NULL);
+   assert(oSNames != NULL);
+
+   if(!FT_addName(oNNode))
+      return FALSE;
+
+   for(c = 0; c < Node_getNumChildren(oNNode); c++) {
+      Node_T oNChild = NULL;
+      (void) Node_getChild(oNNode, c, &oNChild);
+      if(!FT_nameSubtree(oNChild))
+         return FALSE;
+   }
+   return TRUE;
+}
+
+/* Frees name list pvNodes of oSNames, for use with SymTable_map. */
+static void FT_freeNameList(const char *pcName, void *pvNodes,
+                            void *pvExtra) {
+   assert(pcName != NULL);
+   assert(pvNodes != NULL);
+   (void) pvExtra;
+
+   NodeList_free((NodeList_T) pvNodes);
+}
+
+/* Frees oSNames and its lists, and turns name indexing off. */
+static void FT_freeNames(void) {
+   assert(oSNames != NULL);
+
+   SymTable_map(oSNames, FT_freeNameList, NULL);
+   SymTable_free(oSNames);
+   oSNames = NULL;
 }
 
 /*
-  Traverses the FT to find a node with absolute path pcPath. Returns a
-  int SUCCESS status and sets *poNResult to be the node, if found.
-  Otherwise, sets *poNResult to NULL and returns with status:
-  * INITIALIZATION_ERROR if the DT is not in an initialized state
-  * BAD_PATH if pcPath does not represent a well-formatted path
-  * CONFLICTING_PATH if the root's path is not a prefix of pcPath
-  * NO_SUCH_PATH if no node with pcPath exists in the hierarchy
-  * MEMORY_ERROR if memory could not be allocated to complete request
- */
-static int FT_findNode(const char *pcPath, Node_T *poNResult) {
-   Path_T oPPath = NULL;
-   Node_T oNFound = NULL;
-   int iStatus;
+  Adds a binding to oSIndex for every node in the subtree rooted at
+  oNNode. Returns TRUE if successful, or FALSE if memory could not be
+  allocated, in which case some of the bindings may have been added.
+*/
+static boolean FT_indexSubtree(Node_T oNNode) {
+   size_t c;
 
-   assert(pcPath != NULL);
-   assert(poNResult != NULL);
+   assert(oNNode != NULL);
+   assert(oSIndex != NULL);
 
-   if(!bIsInitialized) {
-      *poNResult = NULL;
-      return INITIALIZATION_ERROR;
+   if(!SymTable_put(oSIndex, Path_getPathname(Node_getPath(oNNode)),
+                    oNNode))
+      return FALSE;
+
+   for(c = 0; c < Node_getNumChildren(oNNode); c++) {
+      Node_T oNChild = NULL;
+      (void) Node_getChild(oNNode, c, &oNChild);
+      if(!FT_indexSubtree(oNChild))
+         return FALSE;
    }
+   return TRUE;
+}
 
-   iStatus = Path_new(pcPath, &oPPath);
-   if(iStatus != SUCCESS) {
-      *poNResult = NULL;
-      return iStatus;
+/* Adds the pathname of every node in the subtree rooted at oNNode to
+   oBFilter. */
+static void FT_filterSubtree(Node_T oNNode) {
+   size_t c;
+
+   assert(oNNode != NULL);
+   assert(oBFilter != NULL);
+
+   Bloom_add(oBFilter, Path_getPathname(Node_getPath(oNNode)));
+   for(c = 0; c < Node_getNumChildren(oNNode); c++) {
+      Node_T oNChild = NULL;
+      (void) Node_getChild(oNNode, c, &oNChild);
+      FT_filterSubtree(oNChild);
    }
+}
 
-   iStatus = FT_traversePath(oPPath, &oNFound);
-   if(iStatus != SUCCESS)
-   {
-      Path_free(oPPath);
-      *poNResult = NULL;
-      return iStatus;
+/*
+  Replaces oBFilter with a filter sized for twice the current number
+  of nodes. Leaves the old filter in place if memory could not be
+  allocated, as it is still correct, only less selective.
+*/
+static void FT_resizeFilter(void) {
+   Bloom_T oBNew;
+
+   assert(oBFilter != NULL);
+
+   oBNew = Bloom_new(2 * ulCount);
+   if(oBNew == NULL)
+      return;
+
+   Bloom_free(oBFilter);
+   oBFilter = oBNew;
+   if(oNRoot != NULL)
+      FT_filterSubtree(oNRoot);
+}
+
+/*
+  Removes every node in the subtree rooted at oNNode from oSIndex,
+  oBFilter, and oSNames, for whichever of them are on.
+*/
+static void FT_unindexSubtree(Node_T oNNode) {
+   const char *pcPath;
+   size_t c;
+
+   assert(oNNode != NULL);
+
+   if(oSIndex == NULL && oBFilter == NULL && oSNames == NULL)
+      return;
+
+   pcPath = Path_getPathname(Node_getPath(oNNode));
+   if(oSIndex != NULL)
+      (void) SymTable_remove(oSIndex, pcPath);
+   if(oBFilter != NULL)
+      Bloom_remove(oBFilter, pcPath);
+   if(oSNames != NULL)
+      FT_removeName(oNNode);
+   for(c = 0; c < Node_getNumChildren(oNNode); c++) {
+      Node_T oNChild = NULL;
+      (void) Node_getChild(oNNode, c, &oNChild);
+      FT_unindexSubtree(oNChild);
    }
+}
 
-   if(oNFound == NULL) {
-      Path_free(oPPath);
-      *poNResult = NULL;
-      return NO_SUCH_PATH;
+/*
+  Returns the child of directory oNDir at listing cursor *pulCursor
+  and advances *pulCursor past it, or returns NULL if the listing is
+  complete. Children are listed as in FT_toString: files before
+  directories, and each kind in lexicographic order. A cursor is twice
+  the index of the next child to consider, plus one once the files are
+  done and the directories are being listed; a new listing starts at 0.
+*/
+static Node_T FT_nextListed(Node_T oNDir, size_t *pulCursor) {
+   size_t ulNumChildren;
+   size_t i;
+   boolean bListingDirs;
+
+   assert(oNDir != NULL);
+   assert(pulCursor != NULL);
+
+   ulNumChildren = Node_getNumChildren(oNDir);
+   i = *pulCursor / 2;
+   bListingDirs = (boolean) (*pulCursor % 2);
+
+   for(;;) {
+      for(; i < ulNumChildren; i++) {
+         Node_T oNChild = NULL;
+         (void) Node_getChild(oNDir, i, &oNChild);
+         if(Node_isFile(oNChild) != bListingDirs) {
+            *pulCursor = 2 * (i + 1) + bListingDirs;
+            return oNChild;
+         }
+      }
+      if(bListingDirs) {
+         *pulCursor = 2 * i + 1;
+         return NULL;
+      }
+      bListingDirs = TRUE;
+      i = 0;
    }
+}
 
-   if(Path_comparePath(Node_getPath(oNFound), oPPath) != 0) {
-      Path_free(oPPath);
-      *poNResult = NULL;
-      return NO_SUCH_PATH;
+/*
+  Returns the node that follows the subtree rooted at oNNode in the
+  order FT_toString lists nodes, or NULL if the subtree is listed
+  last.
+*/
+static Node_T FT_nextAfterSubtree(Node_T oNNode) {
+   Node_T oNParent;
+   Node_T oNNext;
+   size_t ulChildID = 0;
+   size_t ulCursor;
+
+   assert(oNNode != NULL);
+
+   for(oNParent = Node_getParent(oNNode); oNParent != NULL;
+       oNNode = oNParent, oNParent = Node_getParent(oNNode)) {
+      /* resume the parent's listing just past oNNode */
+      (void) Node_hasChild(oNParent, Node_getPath(oNNode), &ulChildID);
+      ulCursor = 2 * (ulChildID + 1) + !Node_isFile(oNNode);
+      oNNext = FT_nextListed(oNParent, &ulCursor);
+      if(oNNext != NULL)
+         return oNNext;
    }
+   return NULL;
+}
 
-   Path_free(oPPath);
-   *poNResult = oNFound;
-   return SUCCESS;
+/*
+  Frees the arenas of FT_compact and ends any pass in progress, once
+  the FT has no nodes left in them.
+*/
+static void FT_freeArenas(void) {
+   if(oACompacted != NULL) {
+      Arena_free(oACompacted);
+      oACompacted = NULL;
+   }
+   if(oACompacting != NULL) {
+      Arena_free(oACompacting);
+      oACompacting = NULL;
+   }
+   oNCompactNext = NULL;
 }
 
-/* 
-   Inserts a new node with path pcPath. If isFile is TRUE, then
-   a new file node is inserted with content pvContent and size
-   ulSize, otherwise a directory node is inserted. Returns SUCCESS
-   if successfully inserted, otherwise:
-   * INITIALIZATION_ERROR if the FT is not in an initialized state
-   * BAD_PATH if pcPath does not represent a well-formatted path
-   * CONFLICTING_PATH if the root exists but is not a prefix of pcPath
-   * NOT_A_DIRECTORY if a proper prefix of pcPath exists as a file
-   * ALREADY_IN_TREE if pcPath is already in the FT (as dir or file)
-   * MEMORY_ERROR if memory could not be allocated to complete request
+/*
+  Removes the subtree rooted at oNNode from the FT's directory cache
+  and indexes and frees it. Returns the number of nodes freed.
 */
-static int FT_insert(const char *pcPath, boolean isFile, 
-void* pvContent, size_t ulSize) {
-   int iStatus;
-   Path_T oPPath = NULL;
-   Node_T oNFirstNew = NULL;
-   Node_T oNCurr = NULL;
-   size_t ulDepth, ulIndex;
-   size_t ulNewNodes = 0;
+static size_t FT_freeSubtree(Node_T oNNode) {
+   assert(oNNode != NULL);
+
+   /* a pass of FT_compact resumes after the subtree if it was due to
+      move a node in it */
+   if(oNCompactNext != NULL &&
+      FT_isPrefixPath(Node_getPath(oNNode),
+                      Node_getPath(oNCompactNext)))
+      oNCompactNext = FT_nextAfterSubtree(oNNode);
+
+   FT_forgetSubtree(oNNode);
+   FT_invalidateHandles(oNNode);
+   FT_unindexSubtree(oNNode);
+   return Node_free(oNNode);
+}
 
-   assert(pcPath != NULL);
-   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+/*
+  Creates a new node with path oPPath under oNParent, as Node_newFile
+  does if isFile is TRUE and as Node_newDir does otherwise, and adds it
+  to the FT's indexes. Does not count the node in ulCount. Returns
+  SUCCESS and sets *poNResult to the new node if successful.
+  Otherwise, sets *poNResult to NULL, leaves the FT unchanged, and
+  returns one of the statuses of Node_newFile and Node_newDir.
+*/
+static int FT_newNode(Path_T oPPath, Node_T oNParent, boolean isFile,
+                      void *pvContent, size_t ulSize,
+                      Node_T *poNResult) {
+   int iStatus;
 
-   /* validate pcPath and generate a Path_T for it */
-   if(!bIsInitialized)
-      return INITIALIZATION_ERROR;
+   assert(oPPath != NULL);
+   assert(poNResult != NULL);
 
-   iStatus = Path_new(pcPath, &oPPath);
+   if(isFile)
+      iStatus = Node_newFile(oPPath, oNParent, poNResult,
+                             pvContent, ulSize);
+   else
+      iStatus = Node_newDir(oPPath, oNParent, poNResult);
    if(iStatus != SUCCESS)
       return iStatus;
 
-   /* find the closest ancestor of oPPath already in the tree */
-   iStatus= FT_traversePath(oPPath, &oNCurr);
-   if(iStatus != SUCCESS)
-   {
-      Path_free(oPPath);
-      return iStatus;
+   /* the node is filtered first so that a failed insert can be
+      rolled back by FT_freeSubtree */
+   if(oBFilter != NULL)
+      Bloom_add(oBFilter, Path_getPathname(oPPath));
+   if((oSIndex != NULL &&
+       !SymTable_put(oSIndex, Path_getPathname(oPPath), *poNResult)) ||
+      (oSNames != NULL && !FT_addName(*poNResult))) {
+      (void) FT_freeSubtree(*poNResult);
+      *poNResult = NULL;
+      return MEMORY_ERROR;
+   }
+
+   return SUCCESS;
+}
+
+/*
+  Updates the FT's state after ulNewNodes new nodes were linked in by
+  FT_newNode, the deepest of which is oNLast.
+*/
+static void FT_commitInsert(Node_T oNLast, size_t ulNewNodes) {
+   assert(oNLast != NULL);
+
+   ulCount += ulNewNodes;
+
+   /* later inserts are likely to be siblings of this one */
+   if(Node_getParent(oNLast) != NULL)
+      FT_rememberDir(Node_getParent(oNLast));
+
+   /* keep the filter's false positive rate near its design rate */
+   if(oBFilter != NULL && ulCount > Bloom_getCapacity(oBFilter))
+      FT_resizeFilter();
+}
+
+/*
+  Makes the subtree rooted at oNNewRoot, which has ulNewCount nodes and
+  was built outside the FT, the whole of the FT, which must be empty,
+  and adds its nodes to whichever indexes are on. Returns SUCCESS, or
+  frees the subtree, leaves the FT empty, and returns MEMORY_ERROR if
+  memory could not be allocated to index it.
+*/
+static int FT_adoptTree(Node_T oNNewRoot, size_t ulNewCount) {
+   assert(oNNewRoot != NULL);
+   assert(oNRoot == NULL);
+
+   oNRoot = oNNewRoot;
+   ulCount = ulNewCount;
+   if(oBFilter != NULL) {
+      FT_filterSubtree(oNRoot);
+      if(ulCount > Bloom_getCapacity(oBFilter))
+         FT_resizeFilter();
    }
+   if((oSIndex != NULL && !FT_indexSubtree(oNRoot)) ||
+      (oSNames != NULL && !FT_nameSubtree(oNRoot))) {
+      ulCount -= FT_freeSubtree(oNRoot);
+      oNRoot = NULL;
+      return MEMORY_ERROR;
+   }
+   return SUCCESS;
+}
+
+/*
+  Determines, without allocating memory, the status that looking up
+  pcPath would give if pcPath is known not to be in the FT. Returns:
+  * BAD_PATH if pcPath does not represent a well-formatted path
+  * CONFLICTING_PATH if the root's path is not a prefix of pcPath
+  * NO_SUCH_PATH otherwise
+*/
+static int FT_missingPathStatus(const char *pcPath) {
+   const char *pcRoot;
+   const char *pcCurr;
+
+   assert(pcPath != NULL);
+
+   /* same format rules as Path_new */
+   if(*pcPath == '\0' || *pcPath == '/')
+      return BAD_PATH;
+   for(pcCurr = pcPath; *pcCurr != '\0'; pcCurr++)
+      if(*pcCurr == '/' && (pcCurr[1] == '/' || pcCurr[1] == '\0'))
+         return BAD_PATH;
+
+   /* the first component must be the root's */
+   if(oNRoot != NULL)
+      pcRoot = Path_getPathname(Node_getPath(oNRoot));
+   else if(psFrozen != NULL && psFrozen->ulNumNodes != 0)
+      pcRoot = psFrozen->pcNames + psFrozen->psNodes[0].ulName;
+   else
+      return NO_SUCH_PATH;
+   for(pcCurr = pcPath; *pcCurr != '\0' && *pcCurr != '/'; pcCurr++)
+      if(*pcCurr != pcRoot[pcCurr - pcPath])
+         return CONFLICTING_PATH;
+   if(pcRoot[pcCurr - pcPath] != '\0')
+      return CONFLICTING_PATH;
+
+   return NO_SUCH_PATH;
+}
+
+/* --------------------------------------------------------------------
+
+  The FT_traversePath and FT_findNode functions modularize the common
+  functionality of going as far as possible down an FT towards a path
+  and returning either the node of however far was reached or the
+  node if the full path was reached, respectively.
+*/
+
+/*
+  Descends from node oNStart, whose path must be oPPath or one of its
+  ancestors' paths, as far as possible towards absolute path oPPath.
+  Returns the furthest node reached, which is oPPath's node if it is
+  in the FT. Stops at a file, since files have no children.
+*/
+static Node_T FT_descend(Path_T oPPath, Node_T oNStart) {
+   const char *pcComponent;
+   Node_T oNCurr = oNStart;
+   Node_T oNChild = NULL;
+   size_t ulDepth;
+   size_t i;
+   size_t ulChildID = 0;
+
+   assert(oPPath != NULL);
+   assert(oNStart != NULL);
+
+   /* search each level by component name, so no prefix Path_Ts
+      need to be built on the way down */
+   ulDepth = Path_getDepth(oPPath);
+   for(i = Path_getDepth(Node_getPath(oNCurr));
+       i < ulDepth && !Node_isFile(oNCurr); i++) {
+      /* a chain of only children is crossed in one step by matching
+         oPPath against the path of the chain's end, whose components
+         are atoms like oPPath's, so each level is one pointer
+         comparison rather than a child search */
+      if(Node_getNumChildren(oNCurr) == 1) {
+         Node_T oNEnd = Node_getChainEnd(oNCurr);
+         Path_T oPEnd = Node_getPath(oNEnd);
+         size_t ulEndDepth = Path_getDepth(oPEnd);
+
+         while(i < ulEndDepth && i < ulDepth &&
+               Path_getComponent(oPEnd, i) ==
+               Path_getComponent(oPPath, i))
+            i++;
+         /* oPPath ends or leaves the chain at depth i */
+         if(i < ulEndDepth) {
+            for(; ulEndDepth > i; ulEndDepth--)
+               oNEnd = Node_getParent(oNEnd);
+            return oNEnd;
+         }
+         oNCurr = oNEnd;
+         if(i == ulDepth || Node_isFile(oNCurr))
+            break;
+      }
+
+      /* the component is an atom, whose length is stored with it */
+      pcComponent = Path_getComponent(oPPath, i);
+      if(Node_hasChildName(oNCurr, pcComponent,
+                           Atom_getLength(pcComponent), &ulChildID)) {
+         /* go to that child and continue with next component */
+         (void) Node_getChild(oNCurr, ulChildID, &oNChild);
+         oNCurr = oNChild;
+      }
+      else {
+         /* oNCurr doesn't have child with this component:
+            this is as far as we can go */
+         break;
+      }
+   }
+   return oNCurr;
+}
+
+/*
+  Traverses the FT starting at the deepest cached ancestor of oPPath,
+  or else at the root, as far as possible towards absolute path
+  oPPath. If able to traverse, returns an int SUCCESS
+  status and sets *poNFurthest to the furthest node reached (which may
+  be only a prefix of oPPath, or even NULL if the root is NULL).
+  Otherwise, sets *poNFurthest to NULL and returns with status:
+  * CONFLICTING_PATH if the root's path is not a prefix of oPPath
+*/
+static int FT_traversePath(Path_T oPPath, Node_T *poNFurthest) {
+   Node_T oNCurr;
+
+   assert(oPPath != NULL);
+   assert(poNFurthest != NULL);
+
+   /* root is NULL -> won't find anything */
+   if(oNRoot == NULL) {
+      *poNFurthest = NULL;
+      return SUCCESS;
+   }
+
+   /* a cached ancestor is under the root, so only a traversal that
+      starts from the root needs to check it */
+   oNCurr = FT_cachedAncestor(oPPath);
+   if(oNCurr == NULL) {
+      if(strcmp(Path_getComponent(Node_getPath(oNRoot), 0),
+                Path_getComponent(oPPath, 0))) {
+         *poNFurthest = NULL;
+         return CONFLICTING_PATH;
+      }
+      oNCurr = oNRoot;
+   }
+
+   oNCurr = FT_descend(oPPath, oNCurr);
+
+   /* remember the directory that oPPath's final component was, or
+      would be, looked up in */
+   if(Path_getDepth(Node_getPath(oNCurr)) == Path_getDepth(oPPath)) {
+      if(Node_getParent(oNCurr) != NULL)
+         FT_rememberDir(Node_getParent(oNCurr));
+   }
+   else if(!Node_isFile(oNCurr))
+      FT_rememberDir(oNCurr);
+
+   *poNFurthest = oNCurr;
+   return SUCCESS;
+}
+
+/*
+  Traverses the FT to find a node with absolute path pcPath. Returns a
+  int SUCCESS status and sets *poNResult to be the node, if found.
+  Otherwise, sets *poNResult to NULL and returns with status:
+  * INITIALIZATION_ERROR if the DT is not in an initialized state
+  * BAD_PATH if pcPath does not represent a well-formatted path
+  * CONFLICTING_PATH if the root's path is not a prefix of pcPath
+  * NO_SUCH_PATH if no node with pcPath exists in the hierarchy
+  * MEMORY_ERROR if memory could not be allocated to complete request
+ */
+static int FT_findNode(const char *pcPath, Node_T *poNResult) {
+   Path_T oPPath = NULL;
+   Node_T oNFound = NULL;
+   int iStatus;
+
+   assert(pcPath != NULL);
+   assert(poNResult != NULL);
+
+   if(!bIsInitialized) {
+      *poNResult = NULL;
+      return INITIALIZATION_ERROR;
+   }
+
+   /* an indexed path is well-formed and in the FT, so the index can
+      answer without parsing pcPath; misses still descend to find
+      the right error status */
+   if(oSIndex != NULL) {
+      oNFound = SymTable_get(oSIndex, pcPath);
+      if(oNFound != NULL) {
+         *poNResult = oNFound;
+         return SUCCESS;
+      }
+   }
+
+   /* a filtered-out path is certainly not in the FT */
+   if(oBFilter != NULL && !Bloom_mayContain(oBFilter, pcPath)) {
+      *poNResult = NULL;
+      return FT_missingPathStatus(pcPath);
+   }
+
+   iStatus = Path_new(pcPath, &oPPath);
+   if(iStatus != SUCCESS) {
+      *poNResult = NULL;
+      return iStatus;
+   }
+
+   iStatus = FT_traversePath(oPPath, &oNFound);
+   if(iStatus != SUCCESS)
+   {
+      Path_free(oPPath);
+      *poNResult = NULL;
+      return iStatus;
+   }
+
+   if(oNFound == NULL) {
+      Path_free(oPPath);
+      *poNResult = NULL;
+      return NO_SUCH_PATH;
+   }
+
+   if(Path_comparePath(Node_getPath(oNFound), oPPath) != 0) {
+      Path_free(oPPath);
+      *poNResult = NULL;
+      return NO_SUCH_PATH;
+   }
+
+   Path_free(oPPath);
+   *poNResult = oNFound;
+   return SUCCESS;
+}
+
+/*
+  Compares the name of frozen node psNode with the ulLength bytes at
+  pcName, which need not be '\0'-terminated.
+  Returns <0, 0, or >0 if psNode's name is "less than", "equal to",
+  or "greater than" pcName, respectively.
+*/
+static int FT_compareFrozenName(const struct frozenNode *psNode,
+                                const char *pcName, size_t ulLength) {
+   const char *pcNodeName;
+   int iCompare;
+
+   assert(psNode != NULL);
+   assert(pcName != NULL);
+   assert(psFrozen != NULL);
+
+   pcNodeName = psFrozen->pcNames + psNode->ulName;
+   iCompare = strncmp(pcNodeName, pcName, ulLength);
+   if(iCompare != 0)
+      return iCompare;
+   /* pcName is a prefix of the node's name */
+   return pcNodeName[ulLength] != '\0';
+}
+
+/*
+  Returns the prefix key of the ulLength bytes at pcName: its first
+  sizeof(unsigned long) bytes packed big-endian and padded with '\0',
+  so that comparing keys as integers orders names as strcmp does
+  except that names sharing a full key prefix compare equal.
+*/
+static unsigned long FT_nameKey(const char *pcName, size_t ulLength) {
+   unsigned long ulKey = 0;
+   size_t i;
+
+   assert(pcName != NULL);
+
+   for(i = 0; i < sizeof(unsigned long); i++) {
+      ulKey <<= CHAR_BIT;
+      if(i < ulLength)
+         ulKey |= (unsigned char) pcName[i];
+   }
+   return ulKey;
+}
+
+/*
+  Returns the Eytzinger slot (see struct frozenTree) of the first
+  child in sorted order of a block of ulNumChildren children, or 0 if
+  the block is empty.
+*/
+static size_t FT_firstSlot(size_t ulNumChildren) {
+   size_t ulSlot = 1;
+
+   if(ulNumChildren == 0)
+      return 0;
+   while(2 * ulSlot <= ulNumChildren)
+      ulSlot *= 2;
+   return ulSlot;
+}
+
+/*
+  Returns the Eytzinger slot of the child that comes after the one in
+  slot ulSlot in sorted order, in a block of ulNumChildren children,
+  or 0 if ulSlot holds the last.
+*/
+static size_t FT_nextSlot(size_t ulSlot, size_t ulNumChildren) {
+   assert(ulSlot != 0);
+
+   /* the leftmost slot of the right subtree, if there is one */
+   if(2 * ulSlot + 1 <= ulNumChildren) {
+      ulSlot = 2 * ulSlot + 1;
+      while(2 * ulSlot <= ulNumChildren)
+         ulSlot *= 2;
+      return ulSlot;
+   }
+   /* otherwise the nearest ancestor whose left subtree this is */
+   while(ulSlot % 2 == 1)
+      ulSlot /= 2;
+   return ulSlot / 2;
+}
+
+/*
+  Returns the index in psFrozen->psNodes of the child of frozen
+  directory psDir whose name is the ulLength bytes at pcName, whose
+  key is ulKey, or psFrozen->ulNumNodes if there is none.
+*/
+static size_t FT_searchFrozen(const struct frozenNode *psDir,
+                              const char *pcName, size_t ulLength,
+                              unsigned long ulKey) {
+   const unsigned long *pulKeys;
+   size_t ulBase, ulNumChildren, ulSlot;
+
+   assert(psDir != NULL);
+   assert(pcName != NULL);
+   assert(psFrozen != NULL);
+
+   /* slot k of the block is at ulBase + k */
+   ulBase = psDir->u.sDir.ulFirstChild - 1;
+   ulNumChildren = psDir->u.sDir.ulNumChildren;
+   pulKeys = psFrozen->pulKeys;
+
+   /* descend to the slot after the last child less than pcName; the
+      only branch that depends on the data is on a tie of keys */
+   ulSlot = 1;
+   while(ulSlot <= ulNumChildren) {
+      unsigned long ulSlotKey = pulKeys[ulBase + ulSlot];
+      int iLess;
+
+      if(FROZEN_PREFETCH_SPAN * ulSlot <= ulNumChildren)
+         FT_PREFETCH(&pulKeys[ulBase + FROZEN_PREFETCH_SPAN * ulSlot]);
+      if(ulSlotKey != ulKey)
+         iLess = ulSlotKey < ulKey;
+      else
+         iLess = FT_compareFrozenName(
+            &psFrozen->psNodes[ulBase + ulSlot], pcName, ulLength) < 0;
+      ulSlot = 2 * ulSlot + (size_t) iLess;
+   }
+
+   /* undo the right turns after the last left turn, and that turn,
+      which leaves the slot of the first child not less than pcName */
+   while(ulSlot % 2 == 1)
+      ulSlot /= 2;
+   ulSlot /= 2;
+
+   if(ulSlot == 0 ||
+      FT_compareFrozenName(&psFrozen->psNodes[ulBase + ulSlot], pcName,
+                           ulLength) != 0)
+      return psFrozen->ulNumNodes;
+   return ulBase + ulSlot;
+}
+
+/*
+  Finds the node with absolute path pcPath in the frozen FT, reading
+  pcPath in place one component at a time. Returns SUCCESS and sets
+  *ppsResult to the node if found. Otherwise, sets *ppsResult to NULL
+  and returns one of the statuses of FT_findNode.
+*/
+static int FT_findFrozen(const char *pcPath,
+                         struct frozenNode **ppsResult) {
+   struct frozenNode *psCurr = NULL;
+   const char *pcName = pcPath;
+   const char *pcEnd;
+
+   assert(pcPath != NULL);
+   assert(ppsResult != NULL);
+   assert(psFrozen != NULL);
+
+   *ppsResult = NULL;
+   if(psFrozen->ulNumNodes == 0)
+      return FT_missingPathStatus(pcPath);
+
+   /* a malformed pcPath has an empty component, which never matches,
+      so the error status is only worked out on a miss */
+   for(;;) {
+      size_t ulLength;
+
+      for(pcEnd = pcName; *pcEnd != '/' && *pcEnd != '\0'; pcEnd++)
+         ;
+      ulLength = (size_t) (pcEnd - pcName);
+
+      if(psCurr == NULL) {
+         if(ulLength == 0 ||
+            FT_compareFrozenName(&psFrozen->psNodes[0], pcName,
+                                 ulLength) != 0)
+            return FT_missingPathStatus(pcPath);
+         psCurr = &psFrozen->psNodes[0];
+      }
+      else {
+         size_t ulFound;
+
+         if(psCurr->isFile || ulLength == 0)
+            return FT_missingPathStatus(pcPath);
+         ulFound = FT_searchFrozen(psCurr, pcName, ulLength,
+                                   FT_nameKey(pcName, ulLength));
+         if(ulFound == psFrozen->ulNumNodes)
+            return FT_missingPathStatus(pcPath);
+         psCurr = &psFrozen->psNodes[ulFound];
+      }
+
+      if(*pcEnd == '\0')
+         break;
+      pcName = pcEnd + 1;
+   }
+
+   *ppsResult = psCurr;
+   return SUCCESS;
+}
+
+/* Frees the frozen FT, so that the FT is no longer frozen. */
+static void FT_freeFrozen(void) {
+   assert(psFrozen != NULL);
+
+   free(psFrozen->psNodes);
+   free(psFrozen->pulKeys);
+   free(psFrozen->pcNames);
+   free(psFrozen);
+   psFrozen = NULL;
+}
+
+/*
+  Inserts a new node with path oPPath, given the furthest node towards
+  oPPath already in the FT, oNFurthest (which is NULL only if the FT is
+  empty). If isFile is TRUE, then a new file node is inserted with
+  content pvContent and size ulSize, otherwise a directory node is
+  inserted. Any missing ancestors are inserted as directories.
+  Returns SUCCESS and sets *poNResult to the new node if successfully
+  inserted, otherwise sets *poNResult to NULL, leaves the FT unchanged,
+  and returns:
+  * CONFLICTING_PATH if the new node would be a file at the root
+  * NOT_A_DIRECTORY if a proper prefix of oPPath exists as a file
+  * ALREADY_IN_TREE if oPPath is already in the FT (as dir or file)
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+static int FT_insertBelow(Path_T oPPath, Node_T oNFurthest,
+                          boolean isFile, void *pvContent,
+                          size_t ulSize, Node_T *poNResult) {
+   int iStatus;
+   Node_T oNFirstNew = NULL;
+   Node_T oNCurr = oNFurthest;
+   size_t ulDepth, ulIndex;
+   size_t ulNewNodes = 0;
+
+   assert(oPPath != NULL);
+   assert(oNFurthest != NULL || oNRoot == NULL);
+   assert(poNResult != NULL);
+
+   *poNResult = NULL;
+
+   /* attempting to insert file as root */
+   if ((oNRoot == NULL) && (isFile))
+      return CONFLICTING_PATH;
+
+   ulDepth = Path_getDepth(oPPath);
+   if(oNCurr == NULL) /* new root! */
+      ulIndex = 1;
+   else {
+      ulIndex = Path_getDepth(Node_getPath(oNCurr))+1;
+
+      /* oNCurr is the node we're trying to insert */
+      if(ulIndex == ulDepth+1 && !Path_comparePath(oPPath,
+                                       Node_getPath(oNCurr)))
+         return ALREADY_IN_TREE;
+   }
+
+   /* starting at oNCurr, build rest of the path one level at a time */
+   while(ulIndex <= ulDepth) {
+      Path_T oPPrefix = NULL;
+      Node_T oNNewNode = NULL;
+
+      /* attempting to insert a node under a file */
+      if(oNRoot != NULL && Node_isFile(oNCurr)) {
+         if(oNFirstNew != NULL)
+            (void) FT_freeSubtree(oNFirstNew);
+         return NOT_A_DIRECTORY;
+      }
+
+      /* generate a Path_T for this level */
+      iStatus = Path_prefix(oPPath, ulIndex, &oPPrefix);
+      if(iStatus != SUCCESS) {
+         if(oNFirstNew != NULL)
+            (void) FT_freeSubtree(oNFirstNew);
+         return iStatus;
+      }
+
+      /* insert the new node for this level */
+      iStatus = FT_newNode(oPPrefix, oNCurr, ulIndex == ulDepth && isFile,
+                           pvContent, ulSize, &oNNewNode);
+      Path_free(oPPrefix);
+
+      /* insertion failed */
+      if(iStatus != SUCCESS) {
+         if(oNFirstNew != NULL)
+            (void) FT_freeSubtree(oNFirstNew);
+         return iStatus;
+      }
+
+      /* set up for next level */
+      oNCurr = oNNewNode;
+      ulNewNodes++;
+      if(oNFirstNew == NULL)
+         oNFirstNew = oNCurr;
+      ulIndex++;
+   }
+
+   /* update FT state variables to reflect insertion */
+   if(oNRoot == NULL)
+      oNRoot = oNFirstNew;
+   FT_commitInsert(oNCurr, ulNewNodes);
+
+   *poNResult = oNCurr;
+   return SUCCESS;
+}
+
+/* 
+   Inserts a new node with path pcPath. If isFile is TRUE, then
+   a new file node is inserted with content pvContent and size
+   ulSize, otherwise a directory node is inserted. Returns SUCCESS
+   if successfully inserted, otherwise:
+   * INITIALIZATION_ERROR if the FT is not in an initialized state
+   * BAD_PATH if pcPath does not represent a well-formatted path
+   * CONFLICTING_PATH if the root exists but is not a prefix of pcPath
+   * NOT_A_DIRECTORY if a proper prefix of pcPath exists as a file
+   * ALREADY_IN_TREE if pcPath is already in the FT (as dir or file)
+   * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+static int FT_insert(const char *pcPath, boolean isFile, 
+void* pvContent, size_t ulSize) {
+   int iStatus;
+   Path_T oPPath = NULL;
+   Node_T oNCurr = NULL;
+   Node_T oNNew = NULL;
+
+   assert(pcPath != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   /* validate pcPath and generate a Path_T for it */
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   if(oSIndex != NULL && SymTable_contains(oSIndex, pcPath))
+      return ALREADY_IN_TREE;
+
+   iStatus = Path_new(pcPath, &oPPath);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   /* find the closest ancestor of oPPath already in the tree */
+   iStatus= FT_traversePath(oPPath, &oNCurr);
+   if(iStatus != SUCCESS)
+   {
+      Path_free(oPPath);
+      return iStatus;
+   }
+
+   iStatus = FT_insertBelow(oPPath, oNCurr, isFile, pvContent, ulSize,
+                            &oNNew);
+   Path_free(oPPath);
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   return iStatus;
+}
+
+int FT_insertDir(const char *pcPath) {
+   assert(pcPath != NULL);
+
+   return FT_insert(pcPath, FALSE, NULL, 0);
+}
+
+int FT_insertFile(const char *pcPath, void *pvContents, 
+size_t ulLength) {
+   assert(pcPath != NULL);
+
+   return FT_insert(pcPath, TRUE, pvContents, ulLength);
+}
+
+boolean FT_containsFile(const char *pcPath) {
+   int iStatus;
+   Node_T oNFound = NULL;
+
+   assert(pcPath != NULL);
+
+   if(psFrozen != NULL) {
+      struct frozenNode *psFound = NULL;
+      return FT_findFrozen(pcPath, &psFound) == SUCCESS &&
+         psFound->isFile;
+   }
+
+   iStatus = FT_findNode(pcPath, &oNFound);
+   if (iStatus != SUCCESS) {
+      return FALSE;
+   } else if (!Node_isFile(oNFound)) {
+      return FALSE;
+   }
+   return TRUE;
+}
+
+boolean FT_containsDir(const char *pcPath) {
+   int iStatus;
+   Node_T oNFound = NULL;
+
+   assert(pcPath != NULL);
+
+   if(psFrozen != NULL) {
+      struct frozenNode *psFound = NULL;
+      return FT_findFrozen(pcPath, &psFound) == SUCCESS &&
+         !psFound->isFile;
+   }
+
+   iStatus = FT_findNode(pcPath, &oNFound);
+   if (iStatus != SUCCESS) {
+      return FALSE;
+   } else if (Node_isFile(oNFound)) {
+      return FALSE;
+   }
+   return TRUE;
+}
+
+int FT_rmDir(const char *pcPath) {
+   int iStatus;
+   Node_T oNFound = NULL;
+
+   assert(pcPath != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   iStatus = FT_findNode(pcPath, &oNFound);
+
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   if (Node_isFile(oNFound))
+      return NOT_A_DIRECTORY;
+
+   ulCount -= FT_freeSubtree(oNFound);
+   if(ulCount == 0)
+      oNRoot = NULL;
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   return SUCCESS;
+}
+
+int FT_rmFile(const char *pcPath) {
+   int iStatus;
+   Node_T oNFound = NULL;
+
+   assert(pcPath != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   iStatus = FT_findNode(pcPath, &oNFound);
+
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   if (!Node_isFile(oNFound))
+      return NOT_A_FILE;
+
+   ulCount -= FT_freeSubtree(oNFound);
+   if(ulCount == 0)
+      oNRoot = NULL;
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   return SUCCESS;
+}
+
+void *FT_getFileContents(const char *pcPath) {
+   int iStatus;
+   Node_T oNFound = NULL;
+
+   assert(pcPath != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(psFrozen != NULL) {
+      struct frozenNode *psFound = NULL;
+      if(FT_findFrozen(pcPath, &psFound) != SUCCESS || !psFound->isFile)
+         return NULL;
+      return psFound->u.sFile.pvContent;
+   }
+
+   iStatus = FT_findNode(pcPath, &oNFound);
+
+   if(iStatus != SUCCESS)
+      return NULL;
+
+   assert(Node_isFile(oNFound));
+   if (!Node_isFile(oNFound))
+      return NULL;
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   return Node_getCont(oNFound);
+}
+
+void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
+size_t ulNewLength) {
+   int iStatus;
+   void *pvOldContents;
+   Node_T oNFound = NULL;
+
+   assert(pcPath != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   iStatus = FT_findNode(pcPath, &oNFound);
+
+   if(iStatus != SUCCESS)
+      return NULL;
+
+   assert(Node_isFile(oNFound));
+   if (!Node_isFile(oNFound))
+      return NULL;
+
+   pvOldContents = Node_replaceCont(oNFound, pvNewContents, ulNewLength);
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   return pvOldContents;
+}
+
+int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize) {
+   Node_T oNFound = NULL;
+   int iStatus;
+
+   assert(pcPath != NULL);
+   assert(pbIsFile != NULL);
+   assert(pulSize != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(psFrozen != NULL) {
+      struct frozenNode *psFound = NULL;
+      iStatus = FT_findFrozen(pcPath, &psFound);
+      if(iStatus != SUCCESS)
+         return iStatus;
+      *pbIsFile = psFound->isFile;
+      if(psFound->isFile)
+         *pulSize = psFound->u.sFile.ulSize;
+      return SUCCESS;
+   }
+
+   iStatus = FT_findNode(pcPath, &oNFound);
+
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   if (Node_isFile(oNFound)) {
+      *pbIsFile = TRUE;
+      *pulSize = Node_getContSize(oNFound);
+   } else {
+      *pbIsFile = FALSE;
+   }
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   return SUCCESS;
+}
+
+int FT_init(void) {
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(bIsInitialized || psFrozen != NULL)
+      return INITIALIZATION_ERROR;
+
+   bIsInitialized = TRUE;
+   oNRoot = NULL;
+   ulCount = 0;
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   return SUCCESS;
+}
+
+int FT_destroy(void) {
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized && psFrozen == NULL)
+      return INITIALIZATION_ERROR;
+
+   if(psFrozen != NULL)
+      FT_freeFrozen();
+
+   if(oNRoot) {
+      ulCount -= FT_freeSubtree(oNRoot);
+      oNRoot = NULL;
+   }
+   FT_freeArenas();
+
+   if(oSIndex != NULL) {
+      SymTable_free(oSIndex);
+      oSIndex = NULL;
+   }
+
+   if(oBFilter != NULL) {
+      Bloom_free(oBFilter);
+      oBFilter = NULL;
+   }
+
+   if(oSNames != NULL)
+      FT_freeNames();
+
+   bIsInitialized = FALSE;
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   return SUCCESS;
+}
+
+int FT_enablePathIndex(boolean bEnable) {
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   if(!bEnable) {
+      if(oSIndex != NULL)
+         SymTable_free(oSIndex);
+      oSIndex = NULL;
+      return SUCCESS;
+   }
+
+   if(oSIndex != NULL)
+      return SUCCESS;
+
+   oSIndex = SymTable_new();
+   if(oSIndex == NULL)
+      return MEMORY_ERROR;
+
+   /* index the nodes already in the FT */
+   if(oNRoot != NULL && !FT_indexSubtree(oNRoot)) {
+      SymTable_free(oSIndex);
+      oSIndex = NULL;
+      return MEMORY_ERROR;
+   }
+
+   assert(SymTable_getLength(oSIndex) == ulCount);
+   return SUCCESS;
+}
+
+int FT_enableBloomFilter(boolean bEnable) {
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   if(!bEnable) {
+      if(oBFilter != NULL)
+         Bloom_free(oBFilter);
+      oBFilter = NULL;
+      return SUCCESS;
+   }
+
+   if(oBFilter != NULL)
+      return SUCCESS;
+
+   oBFilter = Bloom_new(2 * ulCount);
+   if(oBFilter == NULL)
+      return MEMORY_ERROR;
+
+   /* filter the nodes already in the FT */
+   if(oNRoot != NULL)
+      FT_filterSubtree(oNRoot);
+
+   return SUCCESS;
+}
+
+int FT_enableNameIndex(boolean bEnable) {
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   if(!bEnable) {
+      if(oSNames != NULL)
+         FT_freeNames();
+      return SUCCESS;
+   }
+
+   if(oSNames != NULL)
+      return SUCCESS;
+
+   oSNames = SymTable_new();
+   if(oSNames == NULL)
+      return MEMORY_ERROR;
+
+   /* list the nodes already in the FT */
+   if(oNRoot != NULL && !FT_nameSubtree(oNRoot)) {
+      FT_freeNames();
+      return MEMORY_ERROR;
+   }
+
+   return SUCCESS;
+}
+
+/*
+  Calls (*pfVisit)(pcPath, bIsFile, pvExtra) as FT_findByName does for
+  each node named pcName in the subtree rooted at oNNode, in tree
+  order, for when oSNames is off.
+*/
+static void FT_findNameInSubtree(Node_T oNNode, const char *pcName,
+                                 void (*pfVisit)(const char *pcPath,
+                                                 boolean bIsFile,
+                                                 void *pvExtra),
+                                 void *pvExtra) {
+   size_t c;
+
+   assert(oNNode != NULL);
+   assert(pcName != NULL);
+   assert(pfVisit != NULL);
+
+   if(!strcmp(Node_getName(oNNode), pcName))
+      (*pfVisit)(Path_getPathname(Node_getPath(oNNode)),
+                 Node_isFile(oNNode), pvExtra);
+   for(c = 0; c < Node_getNumChildren(oNNode); c++) {
+      Node_T oNChild = NULL;
+      (void) Node_getChild(oNNode, c, &oNChild);
+      FT_findNameInSubtree(oNChild, pcName, pfVisit, pvExtra);
+   }
+}
+
+int FT_findByName(const char *pcName,
+                  void (*pfVisit)(const char *pcPath, boolean bIsFile,
+                                  void *pvExtra),
+                  const void *pvExtra) {
+   NodeList_T oDNodes;
+   size_t i;
+
+   assert(pcName != NULL);
+   assert(pfVisit != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+   if(*pcName == '\0' || strchr(pcName, '/') != NULL)
+      return BAD_PATH;
+
+   if(oSNames == NULL) {
+      if(oNRoot != NULL)
+         FT_findNameInSubtree(oNRoot, pcName, pfVisit, (void *) pvExtra);
+      return SUCCESS;
+   }
+
+   oDNodes = SymTable_get(oSNames, pcName);
+   if(oDNodes == NULL)
+      return SUCCESS;
+   for(i = 0; i < NodeList_getLength(oDNodes); i++) {
+      Node_T oNNode = NodeList_get(oDNodes, i);
+      (*pfVisit)(Path_getPathname(Node_getPath(oNNode)),
+                 Node_isFile(oNNode), (void *) pvExtra);
+   }
+   return SUCCESS;
+}
+
+/* --------------------------------------------------------------------
+
+  The following functions implement directory handles, which resolve
+  names relative to an already-found directory so that each operation
+  through a handle costs a single child search.
+*/
+
+/*
+  Returns SUCCESS and sets *pulLength to the length of pcName if it is
+  a well-formatted single path component, or returns BAD_PATH if it is
+  empty or contains a '/'. Finding the length in the same scan lets a
+  lookup through a handle read the name only once.
+*/
+static int FT_checkName(const char *pcName, size_t *pulLength) {
+   const char *pcEnd;
+
+   assert(pcName != NULL);
+   assert(pulLength != NULL);
+
+   for(pcEnd = pcName; *pcEnd != '\0'; pcEnd++)
+      if(*pcEnd == '/')
+         return BAD_PATH;
+   if(pcEnd == pcName)
+      return BAD_PATH;
+   *pulLength = (size_t) (pcEnd - pcName);
+   return SUCCESS;
+}
+
+/*
+  Sets *poNResult to the directory of handle oDDir if it is usable
+  and returns SUCCESS. Otherwise, sets *poNResult to NULL and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * NO_SUCH_PATH if oDDir's directory has been removed from the FT
+*/
+static int FT_getHandleDir(FTDir_T oDDir, Node_T *poNResult) {
+   assert(oDDir != NULL);
+   assert(poNResult != NULL);
+
+   *poNResult = NULL;
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+   if(oDDir->oNDir == NULL)
+      return NO_SUCH_PATH;
+
+   *poNResult = oDDir->oNDir;
+   return SUCCESS;
+}
+
+int FT_openDir(const char *pcPath, FTDir_T *poDResult) {
+   FTDir_T oDDir;
+   Node_T oNFound = NULL;
+   int iStatus;
+
+   assert(pcPath != NULL);
+   assert(poDResult != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   *poDResult = NULL;
+
+   iStatus = FT_findNode(pcPath, &oNFound);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   if(Node_isFile(oNFound))
+      return NOT_A_DIRECTORY;
+
+   if(oDHandles == NULL) {
+      oDHandles = DynArray_new(0);
+      if(oDHandles == NULL)
+         return MEMORY_ERROR;
+   }
+
+   oDDir = malloc(sizeof(struct dirHandle));
+   if(oDDir == NULL)
+      return MEMORY_ERROR;
+   oDDir->oNDir = oNFound;
+
+   if(!DynArray_add(oDHandles, oDDir)) {
+      free(oDDir);
+      return MEMORY_ERROR;
+   }
+
+   *poDResult = oDDir;
+   return SUCCESS;
+}
+
+void FT_closeDir(FTDir_T oDDir) {
+   size_t i;
+
+   assert(oDDir != NULL);
+   assert(oDHandles != NULL);
+
+   for(i = 0; i < DynArray_getLength(oDHandles); i++)
+      if(DynArray_get(oDHandles, i) == oDDir) {
+         (void) DynArray_removeAt(oDHandles, i);
+         break;
+      }
+   free(oDDir);
+
+   if(DynArray_getLength(oDHandles) == 0) {
+      DynArray_free(oDHandles);
+      oDHandles = NULL;
+   }
+}
+
+int FT_insertFileAt(FTDir_T oDDir, const char *pcName,
+                    void *pvContents, size_t ulLength) {
+   Node_T oNDir = NULL;
+   Node_T oNNew = NULL;
+   Path_T oPPath = NULL;
+   char *pcPath;
+   size_t ulDirLength;
+   size_t ulNameLength;
+   int iStatus;
+
+   assert(oDDir != NULL);
+   assert(pcName != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   iStatus = FT_getHandleDir(oDDir, &oNDir);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   iStatus = FT_checkName(pcName, &ulNameLength);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   /* the new node needs its own absolute path */
+   ulDirLength = Path_getStrLength(Node_getPath(oNDir));
+   pcPath = malloc(ulDirLength + ulNameLength + 2);
+   if(pcPath == NULL)
+      return MEMORY_ERROR;
+   strcpy(pcPath, Path_getPathname(Node_getPath(oNDir)));
+   pcPath[ulDirLength] = '/';
+   strcpy(pcPath + ulDirLength + 1, pcName);
+
+   iStatus = Path_new(pcPath, &oPPath);
+   free(pcPath);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   iStatus = FT_newNode(oPPath, oNDir, TRUE, pvContents, ulLength,
+                        &oNNew);
+   Path_free(oPPath);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   FT_commitInsert(oNNew, 1);
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   return SUCCESS;
+}
+
+int FT_lookupAt(FTDir_T oDDir, const char *pcName,
+                boolean *pbIsFile, size_t *pulSize) {
+   Node_T oNDir = NULL;
+   Node_T oNChild = NULL;
+   size_t ulChildID;
+   size_t ulNameLength;
+   int iStatus;
+
+   assert(oDDir != NULL);
+   assert(pcName != NULL);
+   assert(pbIsFile != NULL);
+   assert(pulSize != NULL);
+
+   iStatus = FT_getHandleDir(oDDir, &oNDir);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   iStatus = FT_checkName(pcName, &ulNameLength);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   if(!Node_hasChildName(oNDir, pcName, ulNameLength, &ulChildID))
+      return NO_SUCH_PATH;
+   (void) Node_getChild(oNDir, ulChildID, &oNChild);
+
+   if (Node_isFile(oNChild)) {
+      *pbIsFile = TRUE;
+      *pulSize = Node_getContSize(oNChild);
+   } else {
+      *pbIsFile = FALSE;
+   }
+   return SUCCESS;
+}
+
+int FT_listAt(FTDir_T oDDir,
+              void (*pfVisit)(const char *pcName, boolean bIsFile,
+                              void *pvExtra),
+              const void *pvExtra) {
+   Node_T oNDir = NULL;
+   Node_T oNChild;
+   size_t ulCursor = 0;
+   int iStatus;
+
+   assert(oDDir != NULL);
+   assert(pfVisit != NULL);
+
+   iStatus = FT_getHandleDir(oDDir, &oNDir);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   while((oNChild = FT_nextListed(oNDir, &ulCursor)) != NULL)
+      (*pfVisit)(Node_getName(oNChild), Node_isFile(oNChild),
+                 (void *) pvExtra);
+   return SUCCESS;
+}
+
+/*
+  Finds the directory with absolute path pcPath for a listing. Returns
+  SUCCESS and sets *poNResult to it, or otherwise sets *poNResult to
+  NULL and returns the statuses of FT_findNode, or NOT_A_DIRECTORY if
+  pcPath is a file.
+*/
+static int FT_findListedDir(const char *pcPath, Node_T *poNResult) {
+   int iStatus;
+
+   assert(pcPath != NULL);
+   assert(poNResult != NULL);
+
+   iStatus = FT_findNode(pcPath, poNResult);
+   if(iStatus != SUCCESS)
+      return iStatus;
+   if(Node_isFile(*poNResult)) {
+      *poNResult = NULL;
+      return NOT_A_DIRECTORY;
+   }
+   return SUCCESS;
+}
+
+int FT_listDir(const char *pcPath, size_t *pulCursor,
+               size_t ulMaxEntries, struct dirEntry asEntries[],
+               size_t *pulNumEntries) {
+   Node_T oNDir = NULL;
+   Node_T oNChild;
+   size_t ulCursor;
+   size_t ulNumEntries = 0;
+   int iStatus;
+
+   assert(pcPath != NULL);
+   assert(pulCursor != NULL);
+   assert(asEntries != NULL || ulMaxEntries == 0);
+   assert(pulNumEntries != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   *pulNumEntries = 0;
+
+   iStatus = FT_findListedDir(pcPath, &oNDir);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   ulCursor = *pulCursor;
+   while(ulNumEntries < ulMaxEntries &&
+         (oNChild = FT_nextListed(oNDir, &ulCursor)) != NULL) {
+      asEntries[ulNumEntries].pcName = Node_getName(oNChild);
+      asEntries[ulNumEntries].bIsFile = Node_isFile(oNChild);
+      ulNumEntries++;
+   }
+
+   *pulCursor = ulCursor;
+   *pulNumEntries = ulNumEntries;
+   return SUCCESS;
+}
+
+int FT_listDirPlus(const char *pcPath, size_t *pulCursor,
+                   size_t ulMaxEntries, struct dirEntryPlus asEntries[],
+                   size_t *pulNumEntries) {
+   Node_T oNDir = NULL;
+   Node_T oNChild;
+   size_t ulCursor;
+   size_t ulNumEntries = 0;
+   int iStatus;
+
+   assert(pcPath != NULL);
+   assert(pulCursor != NULL);
+   assert(asEntries != NULL || ulMaxEntries == 0);
+   assert(pulNumEntries != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   *pulNumEntries = 0;
+
+   iStatus = FT_findListedDir(pcPath, &oNDir);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   /* the listing already holds each child, so its stat data costs no
+      lookups */
+   ulCursor = *pulCursor;
+   while(ulNumEntries < ulMaxEntries &&
+         (oNChild = FT_nextListed(oNDir, &ulCursor)) != NULL) {
+      struct dirEntryPlus *psEntry = &asEntries[ulNumEntries];
+      psEntry->pcName = Node_getName(oNChild);
+      psEntry->bIsFile = Node_isFile(oNChild);
+      psEntry->ulSize = psEntry->bIsFile ? Node_getContSize(oNChild) : 0;
+      psEntry->ulNumChildren = Node_getNumChildren(oNChild);
+      ulNumEntries++;
+   }
+
+   *pulCursor = ulCursor;
+   *pulNumEntries = ulNumEntries;
+   return SUCCESS;
+}
+
+/* --------------------------------------------------------------------
+
+  The following functions implement operations on batches of paths.
+  A batch is processed in tree order (see FT_comparePathnames), in
+  which paths that share a prefix are adjacent, so each path can be
+  resolved from the node where the previous one left off instead of
+  from the root.
+*/
+
+/* An entry of a batch of paths */
+struct batchEntry {
+   /* The absolute path of the entry */
+   const char *pcPath;
+   /* The index of the entry in the caller's arrays */
+   size_t ulIndex;
+};
+
+/* Returns TRUE if the ulNumPaths paths of apcPaths are in tree order,
+   as FT_comparePathnames orders them, and FALSE otherwise. */
+static boolean FT_isTreeOrdered(const char *apcPaths[],
+                                size_t ulNumPaths) {
+   size_t i;
+
+   assert(apcPaths != NULL);
+
+   for(i = 1; i < ulNumPaths; i++)
+      if(FT_comparePathnames(apcPaths[i - 1], apcPaths[i]) > 0)
+         return FALSE;
+   return TRUE;
+}
+
+/*
+  Compares batch entries psEntry1 and psEntry2 by pathname as in
+  FT_comparePathnames, and then by their indices in the batch so that
+  sorting keeps equal pathnames in their original order.
+*/
+static int FT_compareBatchEntries(const struct batchEntry *psEntry1,
+                                  const struct batchEntry *psEntry2) {
+   int iCompare;
+
+   assert(psEntry1 != NULL);
+   assert(psEntry2 != NULL);
+
+   iCompare = FT_comparePathnames(psEntry1->pcPath, psEntry2->pcPath);
+   if(iCompare != 0)
+      return iCompare;
+   if(psEntry1->ulIndex < psEntry2->ulIndex)
+      return -1;
+   return psEntry1->ulIndex > psEntry2->ulIndex;
+}
+
+/* The tree order of a batch, whose sort calls FT_compareBatchEntries
+   directly */
+DEFINE_DYNARRAY(BatchOrder, struct batchEntry *,
+                FT_compareBatchEntries)
+
+/* The pathname by which a batch entry is radix sorted */
+#define FT_BATCH_KEY(psEntry) ((psEntry)->pcPath)
+
+/* Radix sorts a batch by pathname in tree order, so that paths
+   sharing a long prefix are not compared from the root each time */
+DEFINE_DYNARRAY_KEYSORT(BatchOrder, struct batchEntry *,
+                        FT_BATCH_KEY, FT_rankPathChar)
+
+/*
+  Puts the ulNumPaths paths of apcPaths in tree order. Sets
+  *ppsEntries to a new array of their batch entries and *poDOrder to a
+  new BatchOrder_T of pointers into it in tree order, which the caller
+  must free, and returns SUCCESS. Sorting is skipped if apcPaths is
+  already in order. Returns MEMORY_ERROR, setting both to NULL, if
+  memory could not be allocated.
+*/
+static int FT_sortBatch(const char *apcPaths[], size_t ulNumPaths,
+                        struct batchEntry **ppsEntries,
+                        BatchOrder_T *poDOrder) {
+   struct batchEntry *psEntries;
+   BatchOrder_T oDOrder;
+   size_t i;
+
+   assert(apcPaths != NULL);
+   assert(ppsEntries != NULL);
+   assert(poDOrder != NULL);
+
+   *ppsEntries = NULL;
+   *poDOrder = NULL;
+
+   /* room for at least one entry, so that malloc(0) is never asked */
+   psEntries = malloc((ulNumPaths + 1) * sizeof(struct batchEntry));
+   if(psEntries == NULL)
+      return MEMORY_ERROR;
+   oDOrder = BatchOrder_new(ulNumPaths);
+   if(oDOrder == NULL) {
+      free(psEntries);
+      return MEMORY_ERROR;
+   }
+
+   for(i = 0; i < ulNumPaths; i++) {
+      assert(apcPaths[i] != NULL);
+      psEntries[i].pcPath = apcPaths[i];
+      psEntries[i].ulIndex = i;
+      (void) BatchOrder_set(oDOrder, i, &psEntries[i]);
+   }
+
+   if(!FT_isTreeOrdered(apcPaths, ulNumPaths))
+      BatchOrder_sortByKey(oDOrder);
+
+   *ppsEntries = psEntries;
+   *poDOrder = oDOrder;
+   return SUCCESS;
+}
+
+/*
+  Returns the node at depth ulDepth on the path from the root to
+  oNNode. ulDepth must be at least 1 and at most oNNode's depth.
+*/
+static Node_T FT_ancestorAt(Node_T oNNode, size_t ulDepth) {
+   size_t ulNodeDepth;
+
+   assert(oNNode != NULL);
+   assert(ulDepth >= 1);
+
+   ulNodeDepth = Path_getDepth(Node_getPath(oNNode));
+   assert(ulDepth <= ulNodeDepth);
+   for(; ulNodeDepth > ulDepth; ulNodeDepth--)
+      oNNode = Node_getParent(oNNode);
+   return oNNode;
+}
+
+/*
+  Traverses the FT as far as possible towards absolute path oPPath,
+  as FT_traversePath does, but given that the previous path of a
+  batch, oPPrev, was resolved as far as node oNPrev: the descent
+  resumes from the deepest node oNPrev shares with oPPath. oPPrev and
+  oNPrev may be NULL if there is no previous path. Returns the same
+  statuses as FT_traversePath.
+*/
+static int FT_resumeTraversal(Path_T oPPath, Path_T oPPrev,
+                              Node_T oNPrev, Node_T *poNFurthest) {
+   size_t ulShared;
+
+   assert(oPPath != NULL);
+   assert(poNFurthest != NULL);
+
+   if(oPPrev != NULL && oNPrev != NULL) {
+      ulShared = Path_getSharedPrefixDepth(oPPath, oPPrev);
+      if(ulShared > Path_getDepth(Node_getPath(oNPrev)))
+         ulShared = Path_getDepth(Node_getPath(oNPrev));
+      /* sharing the root component means sharing the root */
+      if(ulShared >= 1) {
+         *poNFurthest = FT_descend(oPPath,
+                                   FT_ancestorAt(oNPrev, ulShared));
+         return SUCCESS;
+      }
+   }
+
+   return FT_traversePath(oPPath, poNFurthest);
+}
+
+int FT_insertBatch(const char *apcPaths[], void *apvContents[],
+                   const size_t aulLengths[], size_t ulNumPaths,
+                   int aiStatuses[]) {
+   struct batchEntry *psEntries = NULL;
+   BatchOrder_T oDOrder = NULL;
+   Path_T oPPrev = NULL;
+   Node_T oNPrev = NULL;
+   size_t i;
+   int iStatus;
+
+   assert(apcPaths != NULL);
+   assert(apvContents != NULL);
+   assert(aulLengths != NULL);
+   assert(aiStatuses != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized)
+      iStatus = INITIALIZATION_ERROR;
+   else
+      iStatus = FT_sortBatch(apcPaths, ulNumPaths, &psEntries,
+                             &oDOrder);
+   if(iStatus != SUCCESS) {
+      for(i = 0; i < ulNumPaths; i++)
+         aiStatuses[i] = iStatus;
+      return iStatus;
+   }
+
+   for(i = 0; i < ulNumPaths; i++) {
+      struct batchEntry *psEntry = BatchOrder_get(oDOrder, i);
+      Path_T oPPath = NULL;
+      Node_T oNFurthest = NULL;
+      Node_T oNNew = NULL;
+
+      iStatus = Path_new(psEntry->pcPath, &oPPath);
+      if(iStatus != SUCCESS) {
+         aiStatuses[psEntry->ulIndex] = iStatus;
+         continue;
+      }
+
+      iStatus = FT_resumeTraversal(oPPath, oPPrev, oNPrev, &oNFurthest);
+      if(iStatus == SUCCESS)
+         iStatus = FT_insertBelow(oPPath, oNFurthest, TRUE,
+                                  apvContents[psEntry->ulIndex],
+                                  aulLengths[psEntry->ulIndex], &oNNew);
+      aiStatuses[psEntry->ulIndex] = iStatus;
+
+      /* a failed insert leaves oNFurthest, but nothing below it */
+      Path_free(oPPrev);
+      oPPrev = oPPath;
+      oNPrev = (oNNew != NULL) ? oNNew : oNFurthest;
+   }
+
+   Path_free(oPPrev);
+   BatchOrder_free(oDOrder);
+   free(psEntries);
+
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   return SUCCESS;
+}
+
+/*
+  The stages of a lookup in FT_statMany at each level: its node has
+  been prefetched, or its node's children have been.
+*/
+enum { LOOKUP_LOAD, LOOKUP_SEARCH };
+
+/* A lookup in progress in FT_statMany */
+struct statLookup {
+   /* The index of the lookup's path in the caller's arrays */
+   size_t ulIndex;
+   /* The start of the next component of the path to look up */
+   const char *pcNext;
+   /* The directory in which that component is looked up */
+   Node_T oNCurr;
+   /* LOOKUP_LOAD or LOOKUP_SEARCH */
+   int iStage;
+};
+
+/*
+  Stores in *psResult the result of looking up pcPath, which is node
+  oNFound, or is not in the FT if oNFound is NULL.
+*/
+static void FT_recordStat(const char *pcPath, Node_T oNFound,
+                          struct statResult *psResult) {
+   assert(pcPath != NULL);
+   assert(psResult != NULL);
+
+   if(oNFound == NULL) {
+      psResult->iStatus = FT_missingPathStatus(pcPath);
+      return;
+   }
+
+   psResult->iStatus = SUCCESS;
+   psResult->bIsFile = Node_isFile(oNFound);
+   if(psResult->bIsFile)
+      psResult->ulSize = Node_getContSize(oNFound);
+}
+
+/*
+  Starts looking up path pcPath, which is at index ulIndex of the
+  caller's arrays, in *psLookup. Returns TRUE if the lookup has to
+  descend from the root, or FALSE if it was answered at once, in which
+  case its result is stored in *psResult.
+*/
+static boolean FT_startLookup(const char *pcPath, size_t ulIndex,
+                              struct statLookup *psLookup,
+                              struct statResult *psResult) {
+   Node_T oNFound;
+   const char *pcRoot;
+   size_t ulLength;
+
+   assert(pcPath != NULL);
+   assert(psLookup != NULL);
+   assert(psResult != NULL);
+
+   if(oSIndex != NULL) {
+      oNFound = SymTable_get(oSIndex, pcPath);
+      if(oNFound != NULL) {
+         FT_recordStat(pcPath, oNFound, psResult);
+         return FALSE;
+      }
+   }
+
+   if(oNRoot == NULL ||
+      (oBFilter != NULL && !Bloom_mayContain(oBFilter, pcPath))) {
+      FT_recordStat(pcPath, NULL, psResult);
+      return FALSE;
+   }
+
+   pcRoot = Node_getName(oNRoot);
+   ulLength = strlen(pcRoot);
+   if(strncmp(pcPath, pcRoot, ulLength) != 0 ||
+      (pcPath[ulLength] != '\0' && pcPath[ulLength] != '/')) {
+      FT_recordStat(pcPath, NULL, psResult);
+      return FALSE;
+   }
+   if(pcPath[ulLength] == '\0') {
+      FT_recordStat(pcPath, oNRoot, psResult);
+      return FALSE;
+   }
+
+   psLookup->ulIndex = ulIndex;
+   psLookup->pcNext = pcPath + ulLength + 1;
+   psLookup->oNCurr = oNRoot;
+   psLookup->iStage = LOOKUP_LOAD;
+   return TRUE;
+}
+
+/*
+  Advances lookup *psLookup of path pcPath by one stage: prefetching
+  the children of its current directory, or searching them for its
+  next component and prefetching the child found. Only the search
+  waits on memory, and by then the prefetches issued for it have had
+  the other lookups' stages to complete. Returns TRUE if the lookup is
+  still in progress, or FALSE if it is done, in which case its result
+  is stored in *psResult.
+*/
+static boolean FT_stepLookup(struct statLookup *psLookup,
+                             const char *pcPath,
+                             struct statResult *psResult) {
+   const char *pcEnd;
+   Node_T oNChild = NULL;
+   size_t ulChildID = 0;
+
+   assert(psLookup != NULL);
+   assert(pcPath != NULL);
+   assert(psResult != NULL);
+
+   if(psLookup->iStage == LOOKUP_LOAD) {
+      Node_prefetchChildren(psLookup->oNCurr);
+      psLookup->iStage = LOOKUP_SEARCH;
+      return TRUE;
+   }
+
+   for(pcEnd = psLookup->pcNext; *pcEnd != '\0' && *pcEnd != '/';
+       pcEnd++)
+      ;
+   /* an empty component makes the path ill-formed, which
+      FT_recordStat reports */
+   if(Node_isFile(psLookup->oNCurr) || pcEnd == psLookup->pcNext ||
+      !Node_hasChildName(psLookup->oNCurr, psLookup->pcNext,
+                         (size_t) (pcEnd - psLookup->pcNext),
+                         &ulChildID)) {
+      FT_recordStat(pcPath, NULL, psResult);
+      return FALSE;
+   }
+
+   (void) Node_getChild(psLookup->oNCurr, ulChildID, &oNChild);
+   if(*pcEnd == '\0') {
+      FT_recordStat(pcPath, oNChild, psResult);
+      return FALSE;
+   }
+
+   Node_prefetch(oNChild);
+   psLookup->oNCurr = oNChild;
+   psLookup->pcNext = pcEnd + 1;
+   psLookup->iStage = LOOKUP_LOAD;
+   return TRUE;
+}
+
+/*
+  Returns the number of leading components that pathnames pcPath1 and
+  pcPath2 have in common.
+*/
+static size_t FT_sharedComponents(const char *pcPath1,
+                                  const char *pcPath2) {
+   size_t ulShared = 0;
+   size_t i;
+
+   assert(pcPath1 != NULL);
+   assert(pcPath2 != NULL);
+
+   for(i = 0; pcPath1[i] == pcPath2[i]; i++) {
+      if(pcPath1[i] == '\0')
+         return ulShared + 1;
+      if(pcPath1[i] == '/')
+         ulShared++;
+   }
+   /* the last compared component matches if it ends in both */
+   if((pcPath1[i] == '\0' || pcPath1[i] == '/') &&
+      (pcPath2[i] == '\0' || pcPath2[i] == '/'))
+      ulShared++;
+   return ulShared;
+}
+
+/*
+  Returns the part of pathname pcPath after its first ulDepth
+  components and the '/' that follows them, or NULL if pcPath has
+  only ulDepth components.
+*/
+static const char *FT_skipComponents(const char *pcPath,
+                                     size_t ulDepth) {
+   assert(pcPath != NULL);
+
+   for(; ulDepth > 0; ulDepth--) {
+      pcPath = strchr(pcPath, '/');
+      if(pcPath == NULL)
+         return NULL;
+      pcPath++;
+   }
+   return pcPath;
+}
+
+/*
+  Descends from node oNStart as far as possible along pcRest, the
+  components of a path that follow oNStart's. Returns the furthest
+  node reached, and sets *pbFound to TRUE if that is the whole path's
+  node or to FALSE otherwise.
+*/
+static Node_T FT_descendNames(Node_T oNStart, const char *pcRest,
+                              boolean *pbFound) {
+   Node_T oNCurr = oNStart;
+   Node_T oNChild = NULL;
+   size_t ulChildID = 0;
+   const char *pcEnd;
+
+   assert(oNStart != NULL);
+   assert(pcRest != NULL);
+   assert(pbFound != NULL);
+
+   for(;;) {
+      for(pcEnd = pcRest; *pcEnd != '\0' && *pcEnd != '/'; pcEnd++)
+         ;
+      if(Node_isFile(oNCurr) || pcEnd == pcRest ||
+         !Node_hasChildName(oNCurr, pcRest, (size_t) (pcEnd - pcRest),
+                            &ulChildID)) {
+         *pbFound = FALSE;
+         return oNCurr;
+      }
+      (void) Node_getChild(oNCurr, ulChildID, &oNChild);
+      oNCurr = oNChild;
+      if(*pcEnd == '\0') {
+         *pbFound = TRUE;
+         return oNCurr;
+      }
+      pcRest = pcEnd + 1;
+   }
+}
+
+/*
+  Looks up the ulNumPaths paths of apcPaths, which must be in tree
+  order, for FT_statMany. Each path is resolved from the deepest node
+  it shares with the previous path, found by climbing from the node
+  that path reached, so every node of the batch's paths is searched
+  for just once.
+*/
+static void FT_statSorted(const char *apcPaths[], size_t ulNumPaths,
+                          struct statResult asResults[]) {
+   const char *pcPrev = NULL;
+   Node_T oNPrev = NULL;
+   size_t i;
+
+   assert(apcPaths != NULL);
+   assert(asResults != NULL);
+
+   for(i = 0; i < ulNumPaths; i++) {
+      const char *pcPath = apcPaths[i];
+      Node_T oNCurr = NULL;
+      boolean bFound = FALSE;
+      size_t ulDepth = 0;
+
+      assert(pcPath != NULL);
+
+      if(oSIndex != NULL) {
+         oNCurr = SymTable_get(oSIndex, pcPath);
+         bFound = (oNCurr != NULL);
+      }
+      if(oNCurr == NULL && oNRoot != NULL &&
+         (oBFilter == NULL || Bloom_mayContain(oBFilter, pcPath))) {
+         if(pcPrev != NULL) {
+            ulDepth = FT_sharedComponents(pcPrev, pcPath);
+            if(ulDepth > Path_getDepth(Node_getPath(oNPrev)))
+               ulDepth = Path_getDepth(Node_getPath(oNPrev));
+         }
+
+         if(ulDepth >= 1)
+            oNCurr = FT_ancestorAt(oNPrev, ulDepth);
+         else if(FT_sharedComponents(Node_getName(oNRoot), pcPath)
+                 == 1) {
+            oNCurr = oNRoot;
+            ulDepth = 1;
+         }
+
+         /* oNCurr's path is pcPath's first ulDepth components */
+         if(oNCurr != NULL) {
+            const char *pcRest = FT_skipComponents(pcPath, ulDepth);
+            if(pcRest == NULL)
+               bFound = TRUE;
+            else
+               oNCurr = FT_descendNames(oNCurr, pcRest, &bFound);
+         }
+      }
+
+      FT_recordStat(pcPath, bFound ? oNCurr : NULL, &asResults[i]);
+      if(oNCurr != NULL) {
+         pcPrev = pcPath;
+         oNPrev = oNCurr;
+      }
+   }
+}
+
+int FT_statMany(const char *apcPaths[], size_t ulNumPaths,
+                struct statResult asResults[]) {
+   struct statLookup asLookups[STAT_GROUP_LENGTH];
+   size_t ulNumActive = 0;
+   size_t ulNext = 0;
+   size_t i;
+
+   assert(apcPaths != NULL);
+   assert(asResults != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized) {
+      for(i = 0; i < ulNumPaths; i++)
+         asResults[i].iStatus = INITIALIZATION_ERROR;
+      return INITIALIZATION_ERROR;
+   }
+
+   /* sorted paths mostly share their prefixes with their neighbours,
+      which a merge-join exploits better than interleaving */
+   if(FT_isTreeOrdered(apcPaths, ulNumPaths)) {
+      FT_statSorted(apcPaths, ulNumPaths, asResults);
+      return SUCCESS;
+   }
+
+   for(;;) {
+      /* keep the group full, so that each lookup's memory accesses
+         always have other lookups' work to overlap with */
+      while(ulNumActive < STAT_GROUP_LENGTH && ulNext < ulNumPaths) {
+         assert(apcPaths[ulNext] != NULL);
+         if(FT_startLookup(apcPaths[ulNext], ulNext,
+                           &asLookups[ulNumActive], &asResults[ulNext]))
+            ulNumActive++;
+         ulNext++;
+      }
+      if(ulNumActive == 0)
+         break;
+
+      for(i = 0; i < ulNumActive; ) {
+         struct statLookup *psLookup = &asLookups[i];
+         if(FT_stepLookup(psLookup, apcPaths[psLookup->ulIndex],
+                          &asResults[psLookup->ulIndex]))
+            i++;
+         else
+            asLookups[i] = asLookups[--ulNumActive];
+      }
+   }
+
+   return SUCCESS;
+}
+
+/* --------------------------------------------------------------------
+
+  The following functions implement range scans. In tree order (see
+  FT_comparePathnames), every subtree's paths form one contiguous run
+  that starts at its root, so a scan can seek its lower bound with one
+  child search per level and skip any subtree that lies wholly before
+  the range.
+*/
+
+/*
+  Visits, in tree order, each node of the subtree rooted at oNNode
+  whose path is at least pcStart (unless pcStart is NULL) and less than
+  pcEnd (unless pcEnd is NULL), calling (*pfVisit)(pcPath, bIsFile,
+  pvExtra) for it. Returns FALSE if it reached pcEnd, so that no later
+  node can be in the range either, and TRUE otherwise.
+*/
+static boolean FT_scanSubtree(Node_T oNNode, const char *pcStart,
+                              const char *pcEnd,
+                              void (*pfVisit)(const char *pcPath,
+                                              boolean bIsFile,
+                                              void *pvExtra),
+                              void *pvExtra) {
+   const char *pcPath;
+   size_t ulFirst = 0;
+   size_t c;
+
+   assert(oNNode != NULL);
+   assert(pfVisit != NULL);
+
+   pcPath = Path_getPathname(Node_getPath(oNNode));
+   if(pcEnd != NULL && FT_comparePathnames(pcPath, pcEnd) >= 0)
+      return FALSE;
+
+   if(pcStart != NULL && FT_comparePathnames(pcPath, pcStart) < 0) {
+      size_t ulLength = Path_getStrLength(Node_getPath(oNNode));
+      const char *pcName;
+      const char *pcNameEnd;
+
+      /* the whole subtree is before pcStart unless pcStart is in it */
+      if(Node_isFile(oNNode) || strncmp(pcStart, pcPath, ulLength) != 0
+         || pcStart[ulLength] != '/')
+         return TRUE;
+
+      /* children named before pcStart's next component lie wholly
+         before pcStart, and those named after it wholly after */
+      pcName = pcStart + ulLength + 1;
+      for(pcNameEnd = pcName; *pcNameEnd != '\0' && *pcNameEnd != '/';
+          pcNameEnd++)
+         ;
+      if(Node_hasChildName(oNNode, pcName,
+                           (size_t) (pcNameEnd - pcName), &ulFirst)) {
+         Node_T oNChild = NULL;
+         (void) Node_getChild(oNNode, ulFirst, &oNChild);
+         if(!FT_scanSubtree(oNChild, pcStart, pcEnd, pfVisit, pvExtra))
+            return FALSE;
+         ulFirst++;
+      }
+   }
+   else
+      (*pfVisit)(pcPath, Node_isFile(oNNode), pvExtra);
+
+   for(c = ulFirst; c < Node_getNumChildren(oNNode); c++) {
+      Node_T oNChild = NULL;
+      (void) Node_getChild(oNNode, c, &oNChild);
+      if(!FT_scanSubtree(oNChild, NULL, pcEnd, pfVisit, pvExtra))
+         return FALSE;
+   }
+   return TRUE;
+}
+
+int FT_scanRange(const char *pcStart, const char *pcEnd,
+                 void (*pfVisit)(const char *pcPath, boolean bIsFile,
+                                 void *pvExtra),
+                 const void *pvExtra) {
+   assert(pfVisit != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   if(oNRoot != NULL)
+      (void) FT_scanSubtree(oNRoot, pcStart, pcEnd, pfVisit,
+                            (void *) pvExtra);
+   return SUCCESS;
+}
+
+/* --------------------------------------------------------------------
+
+  The following functions implement FT_glob. A pattern is matched one
+  component per level, keeping the set of pattern components that the
+  next level may match as a bit set of "states": state i means the
+  next path component must match pattern component i, and the state
+  one past the last component means the path so far matches in full.
+  Tracking a set, rather than trying each way "**" could match in
+  turn, means every node is examined at most once.
+*/
+
+/* The kinds of a pattern component */
+enum { GLOB_LITERAL, GLOB_WILDCARD, GLOB_ANY_DEPTH };
+
+/* A component of a pattern for FT_glob */
+struct globComponent {
+   /* The component's text, which is not '\0'-terminated */
+   const char *pcText;
+   /* The length of the component's text */
+   size_t ulLength;
+   /* GLOB_LITERAL, GLOB_WILDCARD, or GLOB_ANY_DEPTH (for "**") */
+   int iKind;
+};
+
+/* A parsed pattern for FT_glob */
+struct globPattern {
+   /* The components of the pattern */
+   struct globComponent asComponents[GLOB_MAX_COMPONENTS];
+   /* The number of components */
+   size_t ulNumComponents;
+};
+
+/*
+  Returns TRUE if character c matches the pattern element at
+  pcPattern, which ends before pcPatternEnd: '?', which matches any
+  character, a bracket expression such as "[a-z]" or "[!0-9]", or any
+  other single character, which matches itself. Sets *ppcNext to the
+  element after it either way. A '[' with no closing ']' is an
+  ordinary character.
+*/
+static boolean FT_matchElement(const char *pcPattern,
+                               const char *pcPatternEnd, char c,
+                               const char **ppcNext) {
+   const char *pcClose;
+   const char *pcCurr;
+   boolean bNegate;
+   boolean bMatch = FALSE;
+
+   assert(pcPattern != NULL);
+   assert(pcPattern < pcPatternEnd);
+   assert(ppcNext != NULL);
+
+   *ppcNext = pcPattern + 1;
+   if(*pcPattern == '?')
+      return TRUE;
+   if(*pcPattern != '[')
+      return *pcPattern == c;
+
+   /* a ']' right after the '[' or "[!" is a member, not the end */
+   pcCurr = pcPattern + 1;
+   bNegate = (pcCurr < pcPatternEnd && *pcCurr == '!');
+   if(bNegate)
+      pcCurr++;
+   for(pcClose = pcCurr + 1; pcClose < pcPatternEnd && *pcClose != ']';
+       pcClose++)
+      ;
+   if(pcCurr >= pcPatternEnd || pcClose >= pcPatternEnd)
+      return c == '[';
+
+   for(; pcCurr < pcClose; pcCurr++) {
+      if(pcCurr + 2 < pcClose && pcCurr[1] == '-') {
+         if((unsigned char) pcCurr[0] <= (unsigned char) c &&
+            (unsigned char) c <= (unsigned char) pcCurr[2])
+            bMatch = TRUE;
+         pcCurr += 2;
+      }
+      else if(*pcCurr == c)
+         bMatch = TRUE;
+   }
+   *ppcNext = pcClose + 1;
+   return bMatch != bNegate;
+}
+
+/*
+  Returns TRUE if pcName matches the single-component pattern psGlob,
+  in which '*' matches any string, and every other element matches
+  one character as in FT_matchElement. Returns FALSE otherwise.
+*/
+static boolean FT_matchName(const struct globComponent *psGlob,
+                            const char *pcName) {
+   const char *pcPattern = psGlob->pcText;
+   const char *pcPatternEnd = psGlob->pcText + psGlob->ulLength;
+   const char *pcStarPattern = NULL;
+   const char *pcStarName = NULL;
+   const char *pcNext;
+
+   assert(psGlob != NULL);
+   assert(pcName != NULL);
+
+   /* on a mismatch, let the last '*' absorb one more character */
+   for(;;) {
+      if(pcPattern < pcPatternEnd && *pcPattern == '*') {
+         pcStarPattern = ++pcPattern;
+         pcStarName = pcName;
+         continue;
+      }
+      if(*pcName == '\0')
+         return pcPattern == pcPatternEnd;
+      if(pcPattern < pcPatternEnd &&
+         FT_matchElement(pcPattern, pcPatternEnd, *pcName, &pcNext)) {
+         pcPattern = pcNext;
+         pcName++;
+         continue;
+      }
+      if(pcStarPattern == NULL)
+         return FALSE;
+      pcPattern = pcStarPattern;
+      pcName = ++pcStarName;
+   }
+}
+
+/*
+  Parses pcPattern into *psPattern. Returns SUCCESS, or BAD_PATH if
+  pcPattern is not a well-formatted path or has more than
+  GLOB_MAX_COMPONENTS components.
+*/
+static int FT_parseGlob(const char *pcPattern,
+                        struct globPattern *psPattern) {
+   const char *pcEnd;
+
+   assert(pcPattern != NULL);
+   assert(psPattern != NULL);
+
+   psPattern->ulNumComponents = 0;
+   for(;;) {
+      struct globComponent *psGlob;
+
+      for(pcEnd = pcPattern; *pcEnd != '\0' && *pcEnd != '/'; pcEnd++)
+         ;
+      if(pcEnd == pcPattern ||
+         psPattern->ulNumComponents == GLOB_MAX_COMPONENTS)
+         return BAD_PATH;
+
+      psGlob = &psPattern->asComponents[psPattern->ulNumComponents++];
+      psGlob->pcText = pcPattern;
+      psGlob->ulLength = (size_t) (pcEnd - pcPattern);
+      if(psGlob->ulLength == 2 && !strncmp(pcPattern, "**", 2))
+         psGlob->iKind = GLOB_ANY_DEPTH;
+      else if(strcspn(pcPattern, "*?[/") < psGlob->ulLength)
+         psGlob->iKind = GLOB_WILDCARD;
+      else
+         psGlob->iKind = GLOB_LITERAL;
+
+      if(*pcEnd == '\0')
+         return SUCCESS;
+      pcPattern = pcEnd + 1;
+   }
+}
+
+/*
+  Returns state set ulStates of psPattern with every state of a "**"
+  component also allowing that component to match nothing.
+*/
+static unsigned long FT_closeGlobStates(
+   const struct globPattern *psPattern, unsigned long ulStates) {
+   size_t i;
+
+   assert(psPattern != NULL);
+
+   assert(psPattern->ulNumComponents <= GLOB_MAX_COMPONENTS);
+
+   /* in increasing order, so that runs of "**" close in one pass;
+      the second bound, which FT_parseGlob ensures, lets the compiler
+      see that asComponents is not overrun */
+   for(i = 0; i < psPattern->ulNumComponents &&
+       i < GLOB_MAX_COMPONENTS; i++)
+      if((ulStates >> i & 1UL) &&
+         psPattern->asComponents[i].iKind == GLOB_ANY_DEPTH)
+         ulStates |= 1UL << (i + 1);
+   return ulStates;
+}
+
+/*
+  Returns the states of psPattern after matching a path component
+  named pcName from states ulStates.
+*/
+static unsigned long FT_stepGlob(const struct globPattern *psPattern,
+                                 unsigned long ulStates,
+                                 const char *pcName) {
+   unsigned long ulNext = 0;
+   size_t i;
+
+   assert(psPattern != NULL);
+   assert(pcName != NULL);
+   assert(psPattern->ulNumComponents <= GLOB_MAX_COMPONENTS);
+
+   /* as in FT_closeGlobStates */
+   for(i = 0; i < psPattern->ulNumComponents &&
+       i < GLOB_MAX_COMPONENTS; i++) {
+      const struct globComponent *psGlob = &psPattern->asComponents[i];
+
+      if(!(ulStates >> i & 1UL))
+         continue;
+      if(psGlob->iKind == GLOB_ANY_DEPTH)
+         ulNext |= 1UL << i;
+      else if(psGlob->iKind == GLOB_WILDCARD ?
+              FT_matchName(psGlob, pcName) :
+              !strncmp(psGlob->pcText, pcName, psGlob->ulLength) &&
+              pcName[psGlob->ulLength] == '\0')
+         ulNext |= 1UL << (i + 1);
+   }
+   return FT_closeGlobStates(psPattern, ulNext);
+}
+
+/*
+  Visits oNNode if it matches psPattern in full and continues into its
+  children, given that matching its path left psPattern in states
+  ulStates. Where every state expects a literal name, the children
+  with those names are found by search; otherwise every child is
+  matched in turn.
+*/
+static void FT_globSubtree(Node_T oNNode,
+                           const struct globPattern *psPattern,
+                           unsigned long ulStates,
+                           void (*pfVisit)(const char *pcPath,
+                                           boolean bIsFile,
+                                           void *pvExtra),
+                           void *pvExtra) {
+   unsigned long ulFinal;
+   size_t aulChildIDs[GLOB_MAX_COMPONENTS];
+   size_t ulNumChildIDs = 0;
+   boolean bLiteral = TRUE;
+   size_t i, c;
+
+   assert(oNNode != NULL);
+   assert(psPattern != NULL);
+   assert(pfVisit != NULL);
+
+   ulFinal = 1UL << psPattern->ulNumComponents;
+   if(ulStates & ulFinal)
+      (*pfVisit)(Path_getPathname(Node_getPath(oNNode)),
+                 Node_isFile(oNNode), pvExtra);
+   ulStates &= ~ulFinal;
+   if(ulStates == 0 || Node_isFile(oNNode))
+      return;
+
+   /* as in FT_closeGlobStates */
+   for(i = 0; i < psPattern->ulNumComponents &&
+       i < GLOB_MAX_COMPONENTS && bLiteral; i++) {
+      const struct globComponent *psGlob = &psPattern->asComponents[i];
+      size_t ulChildID;
+
+      if(!(ulStates >> i & 1UL))
+         continue;
+      if(psGlob->iKind != GLOB_LITERAL)
+         bLiteral = FALSE;
+      else if(Node_hasChildName(oNNode, psGlob->pcText,
+                                psGlob->ulLength, &ulChildID)) {
+         /* keep the IDs sorted and distinct, for tree order */
+         for(c = 0; c < ulNumChildIDs && aulChildIDs[c] < ulChildID; c++)
+            ;
+         if(c == ulNumChildIDs || aulChildIDs[c] != ulChildID) {
+            memmove(&aulChildIDs[c + 1], &aulChildIDs[c],
+                    (ulNumChildIDs - c) * sizeof(size_t));
+            aulChildIDs[c] = ulChildID;
+            ulNumChildIDs++;
+         }
+      }
+   }
+
+   if(!bLiteral)
+      ulNumChildIDs = Node_getNumChildren(oNNode);
+   for(c = 0; c < ulNumChildIDs; c++) {
+      Node_T oNChild = NULL;
+      unsigned long ulChildStates;
+
+      (void) Node_getChild(oNNode, bLiteral ? aulChildIDs[c] : c,
+                           &oNChild);
+      ulChildStates = FT_stepGlob(psPattern, ulStates,
+                                  Node_getName(oNChild));
+      if(ulChildStates != 0)
+         FT_globSubtree(oNChild, psPattern, ulChildStates, pfVisit,
+                        pvExtra);
+   }
+}
+
+int FT_glob(const char *pcPattern,
+            void (*pfVisit)(const char *pcPath, boolean bIsFile,
+                            void *pvExtra),
+            const void *pvExtra) {
+   struct globPattern sPattern;
+   unsigned long ulStates;
+   int iStatus;
+
+   assert(pcPattern != NULL);
+   assert(pfVisit != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   iStatus = FT_parseGlob(pcPattern, &sPattern);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   if(oNRoot != NULL) {
+      ulStates = FT_stepGlob(&sPattern,
+                             FT_closeGlobStates(&sPattern, 1UL),
+                             Node_getName(oNRoot));
+      if(ulStates != 0)
+         FT_globSubtree(oNRoot, &sPattern, ulStates, pfVisit,
+                        (void *) pvExtra);
+   }
+   return SUCCESS;
+}
+
+/* --------------------------------------------------------------------
+
+  The following functions build an FT in bulk from a manifest, a
+  stream listing each of its paths after its parent's. Each directory
+  stays open while its subtree is being read, and its children are
+  collected in one array shared by all open directories (a directory's
+  children always come after its ancestors'). When a line leaves a
+  directory's subtree, its children are linked in one exact-size
+  array, so no child search or array insertion is ever needed.
+*/
+
+/* A directory whose subtree is still being read from a manifest */
+struct openDir {
+   /* The directory */
+   Node_T oNDir;
+   /* The index of its first child among the pending nodes */
+   size_t ulFirstChild;
+};
+
+/* The state of a bulk build from a manifest */
+struct manifestBuild {
+   /* The root of the new tree, or NULL before the first line */
+   Node_T oNRoot;
+   /* The number of nodes in the new tree */
+   size_t ulCount;
+   /* The node of the previous line, or NULL before the first line */
+   Node_T oNPrev;
+   /* The open directories, from the root down */
+   struct openDir *psOpen;
+   /* The numbers of used and allocated entries of psOpen */
+   size_t ulNumOpen, ulPhysOpen;
+   /* The nodes not yet linked to their parents, grouped by parent in
+      the same order as psOpen */
+   Node_T *aoNPending;
+   /* The numbers of used and allocated entries of aoNPending */
+   size_t ulNumPending, ulPhysPending;
+};
+
+/*
+  Makes room for at least one more element at the end of the array
+  *ppvArray of elements of ulElemSize bytes, whose allocated length is
+  *pulPhys and of which ulLength are used, doubling it if full.
+  Returns SUCCESS, or MEMORY_ERROR if memory could not be allocated.
+*/
+static int FT_growArray(void **ppvArray, size_t ulLength,
+                        size_t *pulPhys, size_t ulElemSize) {
+   void *pvNew;
+   size_t ulNewPhys;
+
+   assert(ppvArray != NULL);
+   assert(pulPhys != NULL);
+
+   if(ulLength < *pulPhys)
+      return SUCCESS;
+
+   ulNewPhys = (*pulPhys == 0) ? 16 : 2 * *pulPhys;
+   pvNew = realloc(*ppvArray, ulNewPhys * ulElemSize);
+   if(pvNew == NULL)
+      return MEMORY_ERROR;
+   *ppvArray = pvNew;
+   *pulPhys = ulNewPhys;
+   return SUCCESS;
+}
+
+/*
+  Reads the next line of psFile into the buffer *ppcBuffer of
+  *pulLength bytes, growing it as needed, and replaces its newline
+  with '\0'. Returns SUCCESS, setting *pbAtEnd to TRUE instead if
+  there are no more lines, or otherwise returns:
+  * BAD_PATH if psFile could not be read
+  * MEMORY_ERROR if memory could not be allocated
+*/
+static int FT_readLine(FILE *psFile, char **ppcBuffer,
+                       size_t *pulLength, boolean *pbAtEnd) {
+   size_t ulUsed = 0;
+
+   assert(psFile != NULL);
+   assert(ppcBuffer != NULL);
+   assert(pulLength != NULL);
+   assert(pbAtEnd != NULL);
+
+   *pbAtEnd = FALSE;
+   for(;;) {
+      if(*pulLength - ulUsed < 2) {
+         size_t ulNewLength = (*pulLength == 0) ? 256 : 2 * *pulLength;
+         char *pcNew = realloc(*ppcBuffer, ulNewLength);
+         if(pcNew == NULL)
+            return MEMORY_ERROR;
+         *ppcBuffer = pcNew;
+         *pulLength = ulNewLength;
+      }
+      if(fgets(*ppcBuffer + ulUsed, (int) (*pulLength - ulUsed),
+               psFile) == NULL) {
+         /* a read error would otherwise pass for the end of the
+            manifest, and build a truncated tree */
+         if(ferror(psFile))
+            return BAD_PATH;
+         /* a last line without a newline still counts */
+         if(ulUsed == 0)
+            *pbAtEnd = TRUE;
+         return SUCCESS;
+      }
+      ulUsed += strlen(*ppcBuffer + ulUsed);
+      if(ulUsed > 0 && (*ppcBuffer)[ulUsed - 1] == '\n') {
+         (*ppcBuffer)[ulUsed - 1] = '\0';
+         return SUCCESS;
+      }
+   }
+}
+
+/*
+  Splits manifest line pcLine into a path and, if the line has one, a
+  size column: a tab followed by a decimal number. Ends the path at
+  the tab, and sets *pbIsFile to TRUE and *pulSize to the size if
+  there is one, or *pbIsFile to FALSE otherwise. Returns SUCCESS, or
+  BAD_PATH if the size column is empty, has anything but digits, or
+  is too large for an unsigned long.
+*/
+static int FT_splitManifestLine(char *pcLine, boolean *pbIsFile,
+                                size_t *pulSize) {
+   char *pcTab;
+   char *pcEnd;
+   unsigned long ulSize;
+
+   assert(pcLine != NULL);
+   assert(pbIsFile != NULL);
+   assert(pulSize != NULL);
+
+   *pbIsFile = FALSE;
+   *pulSize = 0;
+
+   pcTab = strrchr(pcLine, '\t');
+   if(pcTab == NULL)
+      return SUCCESS;
+
+   *pcTab = '\0';
+   if(pcTab[1] < '0' || pcTab[1] > '9')
+      return BAD_PATH;
+   errno = 0;
+   ulSize = strtoul(pcTab + 1, &pcEnd, 10);
+   if(*pcEnd != '\0' || errno == ERANGE)
+      return BAD_PATH;
+
+   *pbIsFile = TRUE;
+   *pulSize = (size_t) ulSize;
+   return SUCCESS;
+}
+
+/*
+  Compares nodes oNNode1 and oNNode2 by their final path components,
+  which orders siblings as their full paths do.
+*/
+static int FT_compareNodeNames(Node_T oNNode1, Node_T oNNode2) {
+   assert(oNNode1 != NULL);
+   assert(oNNode2 != NULL);
+
+   return strcmp(Node_getName(oNNode1), Node_getName(oNNode2));
+}
+
+/* Returns the rank of character c in strcmp's order. */
+static int FT_rankNameChar(char c) {
+   return (unsigned char) c;
+}
+
+/* The children of a directory being built from a manifest, radix
+   sorted by name */
+DEFINE_DYNARRAY(SiblingArray, Node_T, FT_compareNodeNames)
+DEFINE_DYNARRAY_KEYSORT(SiblingArray, Node_T, Node_getName,
+                        FT_rankNameChar)
+
+/*
+  Links the pending children of psBuild's deepest open directory to it
+  and closes it. Returns SUCCESS, or otherwise leaves psBuild unchanged
+  and returns:
+  * ALREADY_IN_TREE if two of the children have the same path
+  * MEMORY_ERROR if memory could not be allocated
+*/
+static int FT_finishDir(struct manifestBuild *psBuild) {
+   struct openDir *psDir;
+   Node_T *aoNChildren;
+   size_t ulNumChildren;
+   size_t i;
+   int iStatus;
+
+   assert(psBuild != NULL);
+   assert(psBuild->ulNumOpen > 0);
+
+   psDir = &psBuild->psOpen[psBuild->ulNumOpen - 1];
+   aoNChildren = &psBuild->aoNPending[psDir->ulFirstChild];
+   ulNumChildren = psBuild->ulNumPending - psDir->ulFirstChild;
+
+   /* a manifest in tree order lists children already sorted, but one
+      written by FT_toString lists the files before the directories */
+   for(i = 1; i < ulNumChildren; i++)
+      if(FT_compareNodeNames(aoNChildren[i - 1], aoNChildren[i]) >= 0)
+         break;
+   if(i < ulNumChildren) {
+      SiblingArray_sortRangeByKey(aoNChildren, ulNumChildren);
+      for(i = 1; i < ulNumChildren; i++)
+         if(FT_compareNodeNames(aoNChildren[i - 1],
+                                aoNChildren[i]) == 0)
+            return ALREADY_IN_TREE;
+   }
+
+   iStatus = Node_setChildren(psDir->oNDir, aoNChildren, ulNumChildren);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   psBuild->ulNumPending = psDir->ulFirstChild;
+   psBuild->ulNumOpen--;
+   return SUCCESS;
+}
+
+/*
+  Adds a node with path oPPath to psBuild's tree: a file of size
+  ulSize with no contents if isFile is TRUE, or a directory otherwise.
+  Returns SUCCESS, or otherwise returns:
+  * CONFLICTING_PATH if oPPath is not under the root, or is the root
+                     and is a file
+  * NO_SUCH_PATH if oPPath's parent is not the previous line's path
+                 or an open directory
+  * NOT_A_DIRECTORY if oPPath is below the previous line's file
+  * ALREADY_IN_TREE if oPPath is the root's path, or a sibling has the
+                    same path
+  * MEMORY_ERROR if memory could not be allocated
+*/
+static int FT_addManifestNode(struct manifestBuild *psBuild,
+                              Path_T oPPath, boolean isFile,
+                              size_t ulSize) {
+   Node_T oNParent = NULL;
+   Node_T oNNew = NULL;
+   size_t ulDepth;
+   int iStatus;
+
+   assert(psBuild != NULL);
+   assert(oPPath != NULL);
+
+   ulDepth = Path_getDepth(oPPath);
+
+   if(psBuild->oNRoot == NULL) {
+      if(ulDepth != 1)
+         return NO_SUCH_PATH;
+      /* a file can never be the root */
+      if(isFile)
+         return CONFLICTING_PATH;
+   }
+   else {
+      if(Path_getSharedPrefixDepth(oPPath,
+                                   Node_getPath(psBuild->oNRoot)) == 0)
+         return CONFLICTING_PATH;
+      if(ulDepth == 1)
+         return ALREADY_IN_TREE;
+
+      while(psBuild->ulNumOpen >= ulDepth) {
+         iStatus = FT_finishDir(psBuild);
+         if(iStatus != SUCCESS)
+            return iStatus;
+      }
+
+      oNParent = psBuild->psOpen[psBuild->ulNumOpen - 1].oNDir;
+      if(psBuild->ulNumOpen != ulDepth - 1 ||
+         Path_getSharedPrefixDepth(oPPath, Node_getPath(oNParent))
+         != ulDepth - 1) {
+         if(Node_isFile(psBuild->oNPrev) &&
+            FT_isPrefixPath(Node_getPath(psBuild->oNPrev), oPPath))
+            return NOT_A_DIRECTORY;
+         return NO_SUCH_PATH;
+      }
+   }
+
+   iStatus = FT_growArray((void **) &psBuild->aoNPending,
+                          psBuild->ulNumPending,
+                          &psBuild->ulPhysPending, sizeof(Node_T));
+   if(iStatus == SUCCESS && !isFile)
+      iStatus = FT_growArray((void **) &psBuild->psOpen,
+                             psBuild->ulNumOpen, &psBuild->ulPhysOpen,
+                             sizeof(struct openDir));
+   if(iStatus == SUCCESS)
+      iStatus = Node_newUnlinked(oPPath, oNParent, isFile, NULL, ulSize,
+                                 &oNNew);
+   if(iStatus != SUCCESS)
+      return iStatus;
+
+   /* the root is the one node that no directory will link */
+   if(oNParent == NULL)
+      psBuild->oNRoot = oNNew;
+   else
+      psBuild->aoNPending[psBuild->ulNumPending++] = oNNew;
+   if(!isFile) {
+      psBuild->psOpen[psBuild->ulNumOpen].oNDir = oNNew;
+      psBuild->psOpen[psBuild->ulNumOpen].ulFirstChild =
+         psBuild->ulNumPending;
+      psBuild->ulNumOpen++;
+   }
+   psBuild->ulCount++;
+   psBuild->oNPrev = oNNew;
+   return SUCCESS;
+}
+
+/*
+  Reads the manifest psManifest into psBuild, finishing every open
+  directory at its end. Returns SUCCESS, or one of the statuses of
+  FT_buildFromManifest if the manifest could not be read.
+*/
+static int FT_readManifest(FILE *psManifest,
+                           struct manifestBuild *psBuild) {
+   char *pcLine = NULL;
+   size_t ulLineLength = 0;
+   boolean bAtEnd = FALSE;
+   int iStatus;
 
-   /* no ancestor node found, so if root is not NULL,
-      pcPath isn't underneath root. */
-   if(oNCurr == NULL && oNRoot != NULL) {
-      Path_free(oPPath);
-      return CONFLICTING_PATH;
-   }
+   assert(psManifest != NULL);
+   assert(psBuild != NULL);
 
-   /* attempting to insert file as root */
-   if ((bIsInitialized) && (oNRoot == NULL) && (isFile)) {
+   for(;;) {
+      Path_T oPPath = NULL;
+      boolean isFile;
+      size_t ulSize;
+
+      iStatus = FT_readLine(psManifest, &pcLine, &ulLineLength,
+                            &bAtEnd);
+      if(iStatus != SUCCESS || bAtEnd)
+         break;
+      iStatus = FT_splitManifestLine(pcLine, &isFile, &ulSize);
+      if(iStatus == SUCCESS)
+         iStatus = Path_new(pcLine, &oPPath);
+      if(iStatus != SUCCESS)
+         break;
+      iStatus = FT_addManifestNode(psBuild, oPPath, isFile, ulSize);
       Path_free(oPPath);
-      return CONFLICTING_PATH;
+      if(iStatus != SUCCESS)
+         break;
    }
+   free(pcLine);
 
-   ulDepth = Path_getDepth(oPPath);
-   if(oNCurr == NULL) /* new root! */
-      ulIndex = 1;
-   else {
-      ulIndex = Path_getDepth(Node_getPath(oNCurr))+1;
-
-      /* oNCurr is the node we're trying to insert */
-      if(ulIndex == ulDepth+1 && !Path_comparePath(oPPath,
-                                       Node_getPath(oNCurr))) {
-         Path_free(oPPath);
-         return ALREADY_IN_TREE;
-      }
-   }
+   while(iStatus == SUCCESS && psBuild->ulNumOpen > 0)
+      iStatus = FT_finishDir(psBuild);
+   return iStatus;
+}
 
-   /* starting at oNCurr, build rest of the path one level at a time */
-   while(ulIndex <= ulDepth) {
-      Path_T oPPrefix = NULL;
-      Node_T oNNewNode = NULL;
+int FT_buildFromManifest(FILE *psManifest) {
+   struct manifestBuild sBuild;
+   size_t i;
+   int iStatus;
 
-      /* generate a Path_T for this level */
-      iStatus = Path_prefix(oPPath, ulIndex, &oPPrefix);
-      if(iStatus != SUCCESS) {
-         Path_free(oPPath);
-         if(oNFirstNew != NULL)
-            (void) Node_free(oNFirstNew);
-         assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-         return iStatus;
-      }
+   assert(psManifest != NULL);
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
-      /* attempting to insert a node under a file */
-      if(oNRoot != NULL && Node_isFile(oNCurr)) {
-         Path_free(oPPath);
-         Path_free(oPPrefix);
-         if(oNFirstNew != NULL)
-            (void) Node_free(oNFirstNew);
-         assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-         return NOT_A_DIRECTORY;
-      }
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+   if(oNRoot != NULL)
+      return ALREADY_IN_TREE;
 
-      /* insert the new node for this level */
-      if (ulIndex == ulDepth && isFile) {
-         iStatus = Node_newFile(oPPrefix, oNCurr, &oNNewNode, pvContent, ulSize);
-      } else {
-         iStatus = Node_newDir(oPPrefix, oNCurr, &oNNewNode);
-      }
+   sBuild.oNRoot = NULL;
+   sBuild.ulCount = 0;
+   sBuild.oNPrev = NULL;
+   sBuild.psOpen = NULL;
+   sBuild.ulNumOpen = sBuild.ulPhysOpen = 0;
+   sBuild.aoNPending = NULL;
+   sBuild.ulNumPending = sBuild.ulPhysPending = 0;
 
-      /* insertion failed */
-      if(iStatus != SUCCESS) {
-         Path_free(oPPath);
-         Path_free(oPPrefix);
-         if(oNFirstNew != NULL)
-            (void) Node_free(oNFirstNew);
-         assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-         return iStatus;
-      }
+   iStatus = FT_readManifest(psManifest, &sBuild);
 
-      /* set up for next level */
-      Path_free(oPPrefix);
-      oNCurr = oNNewNode;
-      ulNewNodes++;
-      if(oNFirstNew == NULL)
-         oNFirstNew = oNCurr;
-      ulIndex++;
+   if(iStatus != SUCCESS) {
+      /* no pending node is linked yet, so each heads its own subtree;
+         free them deepest first, since an open directory comes before
+         the pending children that still name it as their parent */
+      for(i = sBuild.ulNumPending; i > 0; i--)
+         (void) Node_free(sBuild.aoNPending[i - 1]);
+      if(sBuild.oNRoot != NULL)
+         (void) Node_free(sBuild.oNRoot);
    }
+   else if(sBuild.oNRoot != NULL)
+      iStatus = FT_adoptTree(sBuild.oNRoot, sBuild.ulCount);
 
-   Path_free(oPPath);
-   /* update DT state variables to reflect insertion */
-   if(oNRoot == NULL)
-      oNRoot = oNFirstNew;
-   ulCount += ulNewNodes;
+   free(sBuild.psOpen);
+   free(sBuild.aoNPending);
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-   return SUCCESS;
+   return iStatus;
 }
 
-int FT_insertDir(const char *pcPath) {
-   assert(pcPath != NULL);
-
-   return FT_insert(pcPath, FALSE, NULL, 0);
-}
+/* --------------------------------------------------------------------
 
-int FT_insertFile(const char *pcPath, void *pvContents, 
-size_t ulLength) {
-   assert(pcPath != NULL);
+  The following functions freeze the FT into a struct frozenTree and
+  thaw it back. While the FT is frozen, its nodes and their paths are
+  freed, bIsInitialized is FALSE so that every function that would
+  change the FT fails, and the few read functions that serve a frozen
+  FT check psFrozen first.
+*/
 
-   return FT_insert(pcPath, TRUE, pvContents, ulLength);
-}
+/*
+  Adds the lengths of the names in the subtree rooted at oNNode, each
+  plus one for its '\0', to *pulNamesLength, and records the lengths
+  of their pathnames in psTree's ulMaxPathLength and ulPathsLength.
+*/
+static void FT_measureSubtree(Node_T oNNode, struct frozenTree *psTree,
+                              size_t *pulNamesLength) {
+   size_t ulPathLength;
+   size_t c;
 
-boolean FT_containsFile(const char *pcPath) {
-   int iStatus;
-   Node_T oNFound = NULL;
+   assert(oNNode != NULL);
+   assert(psTree != NULL);
+   assert(pulNamesLength != NULL);
 
-   assert(pcPath != NULL);
+   *pulNamesLength += Atom_getLength(Node_getName(oNNode)) + 1;
+   ulPathLength = Path_getStrLength(Node_getPath(oNNode));
+   psTree->ulPathsLength += ulPathLength + 1;
+   if(ulPathLength > psTree->ulMaxPathLength)
+      psTree->ulMaxPathLength = ulPathLength;
 
-   iStatus = FT_findNode(pcPath, &oNFound);
-   if (iStatus != SUCCESS) {
-      return FALSE;
-   } else if (!Node_isFile(oNFound)) {
-      return FALSE;
+   for(c = 0; c < Node_getNumChildren(oNNode); c++) {
+      Node_T oNChild = NULL;
+      (void) Node_getChild(oNNode, c, &oNChild);
+      FT_measureSubtree(oNChild, psTree, pulNamesLength);
    }
-   return TRUE;
 }
 
-boolean FT_containsDir(const char *pcPath) {
-   int iStatus;
-   Node_T oNFound = NULL;
-
-   assert(pcPath != NULL);
+/*
+  Copies oNNode into psTree as node ulIndex, and its subtree after
+  it: each directory's children take the block of *pulNext onwards in
+  Eytzinger order, *pulNext is then advanced past them, and each name
+  is copied to offset *pulNames of the pool, which is then advanced
+  past it.
+*/
+static void FT_freezeNode(Node_T oNNode, struct frozenTree *psTree,
+                          size_t ulIndex, size_t *pulNext,
+                          size_t *pulNames) {
+   struct frozenNode *psNode;
+   const char *pcName;
+   size_t ulNameLength;
+   size_t ulFirst, ulNumChildren, ulSlot, c;
+
+   assert(oNNode != NULL);
+   assert(psTree != NULL);
+   assert(pulNext != NULL);
+   assert(pulNames != NULL);
+
+   psNode = &psTree->psNodes[ulIndex];
+   pcName = Node_getName(oNNode);
+   psNode->ulName = *pulNames;
+   strcpy(psTree->pcNames + *pulNames, pcName);
+   ulNameLength = Atom_getLength(pcName);
+   *pulNames += ulNameLength + 1;
+   psTree->pulKeys[ulIndex] = FT_nameKey(pcName, ulNameLength);
+
+   psNode->isFile = Node_isFile(oNNode);
+   if(psNode->isFile) {
+      psNode->u.sFile.pvContent = Node_getCont(oNNode);
+      psNode->u.sFile.ulSize = Node_getContSize(oNNode);
+      return;
+   }
 
-   iStatus = FT_findNode(pcPath, &oNFound);
-   if (iStatus != SUCCESS) {
-      return FALSE;
-   } else if (Node_isFile(oNFound)) {
-      return FALSE;
+   ulFirst = *pulNext;
+   ulNumChildren = Node_getNumChildren(oNNode);
+   psNode->u.sDir.ulFirstChild = ulFirst;
+   psNode->u.sDir.ulNumChildren = ulNumChildren;
+   *pulNext += ulNumChildren;
+   /* children are taken in sorted order and placed in their slots */
+   for(c = 0, ulSlot = FT_firstSlot(ulNumChildren); c < ulNumChildren;
+       c++, ulSlot = FT_nextSlot(ulSlot, ulNumChildren)) {
+      Node_T oNChild = NULL;
+      (void) Node_getChild(oNNode, c, &oNChild);
+      FT_freezeNode(oNChild, psTree, ulFirst + ulSlot - 1, pulNext,
+                    pulNames);
    }
-   return TRUE;
 }
 
-int FT_rmDir(const char *pcPath) {
-   int iStatus;
-   Node_T oNFound = NULL;
+int FT_freeze(void) {
+   struct frozenTree *psTree;
+   size_t ulNamesLength = 0;
+   size_t ulNext = 1;
+   size_t ulNames = 0;
 
-   assert(pcPath != NULL);
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
-   iStatus = FT_findNode(pcPath, &oNFound);
-
-   if(iStatus != SUCCESS)
-      return iStatus;
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
 
-   if (Node_isFile(oNFound))
-      return NOT_A_DIRECTORY;
+   psTree = malloc(sizeof(struct frozenTree));
+   if(psTree == NULL)
+      return MEMORY_ERROR;
+   psTree->psNodes = NULL;
+   psTree->pulKeys = NULL;
+   psTree->ulNumNodes = ulCount;
+   psTree->pcNames = NULL;
+   psTree->ulMaxPathLength = 0;
+   psTree->ulPathsLength = 0;
+
+   if(oNRoot != NULL) {
+      FT_measureSubtree(oNRoot, psTree, &ulNamesLength);
+      psTree->psNodes = malloc(ulCount * sizeof(struct frozenNode));
+      psTree->pulKeys = malloc(ulCount * sizeof(unsigned long));
+      psTree->pcNames = malloc(ulNamesLength);
+      if(psTree->psNodes == NULL || psTree->pulKeys == NULL ||
+         psTree->pcNames == NULL) {
+         free(psTree->psNodes);
+         free(psTree->pulKeys);
+         free(psTree->pcNames);
+         free(psTree);
+         return MEMORY_ERROR;
+      }
+      FT_freezeNode(oNRoot, psTree, 0, &ulNext, &ulNames);
+      assert(ulNext == ulCount);
 
-   ulCount -= Node_free(oNFound);
-   if(ulCount == 0)
+      ulCount -= FT_freeSubtree(oNRoot);
       oNRoot = NULL;
+   }
+   FT_freeArenas();
+
+   psFrozen = psTree;
+   bIsInitialized = FALSE;
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
    return SUCCESS;
 }
 
-int FT_rmFile(const char *pcPath) {
+/*
+  Rebuilds frozen node ulIndex and its subtree as live nodes under
+  oNParent (NULL for the root), and sets *poNResult to the new node.
+  The children of each directory are gathered in sorted order in the
+  part of aoNNodes that the directory's block takes in the frozen
+  nodes. pcPath holds the node's pathname in its first ulLength
+  characters and has room for the longest pathname. Returns SUCCESS,
+  or frees whatever it built and returns MEMORY_ERROR.
+*/
+static int FT_thawNode(size_t ulIndex, Node_T oNParent, char *pcPath,
+                       size_t ulLength, Node_T aoNNodes[],
+                       Node_T *poNResult) {
+   struct frozenNode *psNode;
+   Path_T oPPath = NULL;
+   Node_T oNNode = NULL;
+   size_t ulFirst, ulNumChildren, ulSlot, c;
    int iStatus;
-   Node_T oNFound = NULL;
 
    assert(pcPath != NULL);
-   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-
-   iStatus = FT_findNode(pcPath, &oNFound);
+   assert(aoNNodes != NULL);
+   assert(poNResult != NULL);
+   assert(psFrozen != NULL);
 
+   psNode = &psFrozen->psNodes[ulIndex];
+   pcPath[ulLength] = '\0';
+   iStatus = Path_new(pcPath, &oPPath);
    if(iStatus != SUCCESS)
       return iStatus;
+   if(psNode->isFile)
+      iStatus = Node_newUnlinked(oPPath, oNParent, TRUE,
+                                 psNode->u.sFile.pvContent,
+                                 psNode->u.sFile.ulSize, &oNNode);
+   else
+      iStatus = Node_newUnlinked(oPPath, oNParent, FALSE, NULL, 0,
+                                 &oNNode);
+   Path_free(oPPath);
+   if(iStatus != SUCCESS)
+      return iStatus;
+   *poNResult = oNNode;
+   if(psNode->isFile)
+      return SUCCESS;
 
-   if (!Node_isFile(oNFound))
-      return NOT_A_FILE;
-
-   ulCount -= Node_free(oNFound);
-   if(ulCount == 0)
-      oNRoot = NULL;
-
-   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-   return SUCCESS;
+   ulFirst = psNode->u.sDir.ulFirstChild;
+   ulNumChildren = psNode->u.sDir.ulNumChildren;
+   for(c = 0, ulSlot = FT_firstSlot(ulNumChildren); c < ulNumChildren;
+       c++, ulSlot = FT_nextSlot(ulSlot, ulNumChildren)) {
+      size_t ulChild = ulFirst + ulSlot - 1;
+      const char *pcName =
+         psFrozen->pcNames + psFrozen->psNodes[ulChild].ulName;
+      size_t ulNameLength = strlen(pcName);
+
+      pcPath[ulLength] = '/';
+      memcpy(pcPath + ulLength + 1, pcName, ulNameLength);
+      iStatus = FT_thawNode(ulChild, oNNode, pcPath,
+                            ulLength + 1 + ulNameLength, aoNNodes,
+                            &aoNNodes[ulFirst + c]);
+      if(iStatus != SUCCESS)
+         break;
+   }
+   if(iStatus == SUCCESS)
+      iStatus = Node_setChildren(oNNode, &aoNNodes[ulFirst],
+                                 ulNumChildren);
+   if(iStatus != SUCCESS) {
+      /* the c children built are not yet linked to oNNode, so each
+         heads its own subtree */
+      while(c > 0)
+         (void) Node_free(aoNNodes[ulFirst + --c]);
+      (void) Node_free(oNNode);
+      *poNResult = NULL;
+   }
+   return iStatus;
 }
 
-void *FT_getFileContents(const char *pcPath) {
+int FT_thaw(void) {
+   Node_T *aoNNodes;
+   Node_T oNNewRoot = NULL;
+   char *pcPath;
+   const char *pcRootName;
    int iStatus;
-   Node_T oNFound = NULL;
 
-   assert(pcPath != NULL);
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
-   iStatus = FT_findNode(pcPath, &oNFound);
+   if(psFrozen == NULL)
+      return INITIALIZATION_ERROR;
 
-   if(iStatus != SUCCESS)
-      return NULL;
+   bIsInitialized = TRUE;
+   if(psFrozen->ulNumNodes != 0) {
+      aoNNodes = malloc(psFrozen->ulNumNodes * sizeof(Node_T));
+      pcPath = malloc(psFrozen->ulMaxPathLength + 1);
+      if(aoNNodes == NULL || pcPath == NULL) {
+         free(aoNNodes);
+         free(pcPath);
+         bIsInitialized = FALSE;
+         return MEMORY_ERROR;
+      }
 
-   assert(Node_isFile(oNFound));
-   if (!Node_isFile(oNFound))
-      return NULL;
+      pcRootName = psFrozen->pcNames + psFrozen->psNodes[0].ulName;
+      strcpy(pcPath, pcRootName);
+      iStatus = FT_thawNode(0, NULL, pcPath, strlen(pcRootName),
+                            aoNNodes, &oNNewRoot);
+      if(iStatus == SUCCESS)
+         iStatus = FT_adoptTree(oNNewRoot, psFrozen->ulNumNodes);
+      free(aoNNodes);
+      free(pcPath);
+
+      /* the FT stays frozen if it could not be rebuilt */
+      if(iStatus != SUCCESS) {
+         bIsInitialized = FALSE;
+         return iStatus;
+      }
+   }
+
+   FT_freeFrozen();
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-   return Node_getCont(oNFound);
+   return SUCCESS;
 }
 
-void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
-size_t ulNewLength) {
-   int iStatus;
-   void *pvOldContents;
-   Node_T oNFound = NULL;
+/*
+  Writes the pathnames of frozen node ulIndex and its subtree to
+  pcOut in FT_toString's order, each followed by a newline, given the
+  node's pathname in the first ulLength characters of pcPath, which
+  has room for the longest pathname. Returns the end of what was
+  written.
+*/
+static char *FT_writeFrozen(size_t ulIndex, char *pcPath,
+                            size_t ulLength, char *pcOut) {
+   struct frozenNode *psNode;
+   size_t ulNumChildren, ulSlot;
+   int iPass;
 
    assert(pcPath != NULL);
-   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   assert(pcOut != NULL);
+   assert(psFrozen != NULL);
+
+   memcpy(pcOut, pcPath, ulLength);
+   pcOut[ulLength] = '\n';
+   pcOut += ulLength + 1;
+
+   psNode = &psFrozen->psNodes[ulIndex];
+   if(psNode->isFile)
+      return pcOut;
+
+   /* files come before directories, as in FT_preOrderTraversal */
+   ulNumChildren = psNode->u.sDir.ulNumChildren;
+   for(iPass = 0; iPass < 2; iPass++)
+      for(ulSlot = FT_firstSlot(ulNumChildren); ulSlot != 0;
+          ulSlot = FT_nextSlot(ulSlot, ulNumChildren)) {
+         size_t ulChild = psNode->u.sDir.ulFirstChild + ulSlot - 1;
+         const char *pcName =
+            psFrozen->pcNames + psFrozen->psNodes[ulChild].ulName;
+         size_t ulNameLength = strlen(pcName);
+
+         if(psFrozen->psNodes[ulChild].isFile != (iPass == 0))
+            continue;
+         pcPath[ulLength] = '/';
+         memcpy(pcPath + ulLength + 1, pcName, ulNameLength);
+         pcOut = FT_writeFrozen(ulChild, pcPath,
+                                ulLength + 1 + ulNameLength, pcOut);
+      }
+   return pcOut;
+}
 
-   iStatus = FT_findNode(pcPath, &oNFound);
+/*
+  Returns FT_toString's representation of the frozen FT, or NULL if
+  there is an allocation error.
+*/
+static char *FT_frozenToString(void) {
+   char *pcResult;
+   char *pcPath;
+   char *pcEnd;
+   const char *pcRootName;
 
-   if(iStatus != SUCCESS)
-      return NULL;
+   assert(psFrozen != NULL);
 
-   assert(Node_isFile(oNFound));
-   if (!Node_isFile(oNFound))
+   pcResult = malloc(psFrozen->ulPathsLength + 1);
+   if(pcResult == NULL)
       return NULL;
+   pcEnd = pcResult;
 
-   pvOldContents = Node_replaceCont(oNFound, pvNewContents, ulNewLength);
+   if(psFrozen->ulNumNodes != 0) {
+      pcPath = malloc(psFrozen->ulMaxPathLength + 1);
+      if(pcPath == NULL) {
+         free(pcResult);
+         return NULL;
+      }
+      pcRootName = psFrozen->pcNames + psFrozen->psNodes[0].ulName;
+      strcpy(pcPath, pcRootName);
+      pcEnd = FT_writeFrozen(0, pcPath, strlen(pcRootName), pcEnd);
+      free(pcPath);
+   }
+   *pcEnd = '\0';
 
-   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
-   return pvOldContents;
+   return pcResult;
 }
 
-int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize) {
-   Node_T oNFound = NULL;
+/* --------------------------------------------------------------------
+
+  The following functions compact the FT by moving its nodes, in the
+  order FT_toString lists them, into one arena per pass. A pass can be
+  spread over many calls of FT_compact, with the FT changing in
+  between: nodes inserted behind oNCompactNext are simply not moved,
+  and FT_freeSubtree moves oNCompactNext past a subtree it removes.
+  Every node in the previous pass's arena has therefore been moved or
+  freed by the end of the next pass, when that arena is freed.
+*/
+
+/*
+  Moves oNNode into oACompacting, and replaces every reference to it
+  held outside the nodes themselves with its copy, which is stored in
+  *poNResult. Returns SUCCESS, or MEMORY_ERROR if the arena could not
+  grow, in which case nothing changes.
+*/
+static int FT_relocateNode(Node_T oNNode, Node_T *poNResult) {
+   NodeList_T oDNodes = NULL;
+   size_t ulNameIndex = 0;
+   Node_T oNOld = oNNode;
+   size_t i;
    int iStatus;
 
-   assert(pcPath != NULL);
-   assert(pbIsFile != NULL);
-   assert(pulSize != NULL);
-   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+   assert(oNNode != NULL);
+   assert(poNResult != NULL);
+   assert(oACompacting != NULL);
 
-   iStatus = FT_findNode(pcPath, &oNFound);
+   /* the name list is searched while the node can still be read */
+   if(oSNames != NULL) {
+      oDNodes = SymTable_get(oSNames, Node_getName(oNNode));
+      if(!NodeList_bsearch(oDNodes, oNNode, &ulNameIndex))
+         oDNodes = NULL;
+   }
 
+   iStatus = Node_relocate(oNNode, oACompacting, poNResult);
    if(iStatus != SUCCESS)
       return iStatus;
+   oNNode = *poNResult;
 
-   if (Node_isFile(oNFound)) {
-      *pbIsFile = TRUE;
-      *pulSize = Node_getContSize(oNFound);
-   } else {
-      *pbIsFile = FALSE;
-   }
+   /* from here on the old node is only compared, never read */
+   if(oNRoot == oNOld)
+      oNRoot = oNNode;
+
+   for(i = 0; i < DIR_CACHE_LENGTH; i++)
+      if(aoNDirCache[i] == oNOld)
+         aoNDirCache[i] = oNNode;
+
+   if(oDHandles != NULL)
+      for(i = 0; i < DynArray_getLength(oDHandles); i++) {
+         FTDir_T oDDir = DynArray_get(oDHandles, i);
+         if(oDDir->oNDir == oNOld)
+            oDDir->oNDir = oNNode;
+      }
+
+   if(oSIndex != NULL)
+      (void) SymTable_replace(oSIndex,
+                              Path_getPathname(Node_getPath(oNNode)),
+                              oNNode);
+
+   if(oDNodes != NULL)
+      (void) NodeList_set(oDNodes, ulNameIndex, oNNode);
 
-   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
    return SUCCESS;
 }
 
-int FT_init(void) {
+int FT_compact(size_t ulMaxNodes, boolean *pbDone) {
+   size_t ulMoved = 0;
+   int iStatus;
+
+   assert(pbDone != NULL);
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
 
-   if(bIsInitialized)
+   if(!bIsInitialized)
       return INITIALIZATION_ERROR;
 
-   bIsInitialized = TRUE;
-   oNRoot = NULL;
-   ulCount = 0;
+   *pbDone = FALSE;
+   if(oACompacting == NULL) {
+      oACompacting = Arena_newHuge(COMPACT_CHUNK_SIZE);
+      if(oACompacting == NULL)
+         return MEMORY_ERROR;
+      oNCompactNext = oNRoot;
+   }
+
+   while(oNCompactNext != NULL &&
+         (ulMaxNodes == 0 || ulMoved < ulMaxNodes)) {
+      Node_T oNNew = NULL;
+      size_t ulCursor = 0;
+
+      iStatus = FT_relocateNode(oNCompactNext, &oNNew);
+      if(iStatus != SUCCESS)
+         return iStatus;
+      ulMoved++;
+
+      /* a directory's own files, then its subdirectories, come next,
+         so that a walk in FT_toString's order reads the arena from
+         start to end */
+      if(Node_isFile(oNNew) ||
+         (oNCompactNext = FT_nextListed(oNNew, &ulCursor)) == NULL)
+         oNCompactNext = FT_nextAfterSubtree(oNNew);
+   }
+
+   if(oNCompactNext == NULL) {
+      if(oACompacted != NULL)
+         Arena_free(oACompacted);
+      oACompacted = oACompacting;
+      oACompacting = NULL;
+      *pbDone = TRUE;
+   }
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
    return SUCCESS;
 }
 
-int FT_destroy(void) {
-   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+int FT_getHugePageSize(size_t *pulSize) {
+   assert(pulSize != NULL);
 
    if(!bIsInitialized)
       return INITIALIZATION_ERROR;
 
-   if(oNRoot) {
-      ulCount -= Node_free(oNRoot);
-      oNRoot = NULL;
+   *pulSize = 0;
+   if(oACompacted != NULL)
+      *pulSize += Arena_getHugeSize(oACompacted);
+   if(oACompacting != NULL)
+      *pulSize += Arena_getHugeSize(oACompacting);
+   return SUCCESS;
+}
+
+/*
+  Releases the slack capacity of the children arrays of every
+  directory in the subtree rooted at oNNode.
+*/
+static void FT_trimSubtree(Node_T oNNode) {
+   size_t c;
+
+   assert(oNNode != NULL);
+
+   Node_trimChildren(oNNode);
+   for(c = 0; c < Node_getNumChildren(oNNode); c++) {
+      Node_T oNChild = NULL;
+      (void) Node_getChild(oNNode, c, &oNChild);
+      FT_trimSubtree(oNChild);
    }
+}
 
-   bIsInitialized = FALSE;
+/* Releases the slack capacity of name list pvNodes of oSNames, for
+   use with SymTable_map. */
+static void FT_trimNameList(const char *pcName, void *pvNodes,
+                            void *pvExtra) {
+   assert(pcName != NULL);
+   assert(pvNodes != NULL);
+   (void) pvExtra;
+
+   NodeList_shrinkToFit((NodeList_T) pvNodes);
+}
+
+int FT_trimMemory(void) {
+   assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
+
+   if(!bIsInitialized)
+      return INITIALIZATION_ERROR;
+
+   if(oNRoot != NULL)
+      FT_trimSubtree(oNRoot);
+   if(oSNames != NULL)
+      SymTable_map(oSNames, FT_trimNameList, NULL);
+   if(oDHandles != NULL)
+      DynArray_shrinkToFit(oDHandles);
 
    assert(CheckerFT_isValid(bIsInitialized, oNRoot, ulCount));
    return SUCCESS;
 }
 
-
 /* --------------------------------------------------------------------
 
   The following auxiliary functions are used for generating the
@@ -544,6 +3829,9 @@ char *FT_toString(void) {
    size_t totalStrlen = 1;
    char *result = NULL;
 
+   if(psFrozen != NULL)
+      return FT_frozenToString();
+
    if(!bIsInitialized)
       return NULL;
 
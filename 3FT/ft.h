@@ -13,6 +13,7 @@
 */
 
 #include <stddef.h>
+#include <stdio.h>
 #include "a4def.h"
 
 /*
@@ -135,6 +136,364 @@ int FT_init(void);
 */
 int FT_destroy(void);
 
+/*
+  Turns the full-path index on if bEnable is TRUE, or off otherwise.
+  While the index is on, every node is also reachable by a hash of its
+  full pathname, so looking up a path that is in the FT takes one hash
+  table probe regardless of its depth, at the cost of a copy of every
+  pathname. The index is kept in sync by every FT operation and is
+  turned off by FT_destroy.
+  Returns SUCCESS if the index is now in the requested state.
+  Otherwise, returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated to build the index,
+                 in which case the index remains off
+*/
+int FT_enablePathIndex(boolean bEnable);
+
+/*
+  Turns the negative lookup filter on if bEnable is TRUE, or off
+  otherwise. While the filter is on, a counting Bloom filter over the
+  full pathnames in the FT lets most lookups of paths that are not in
+  the FT (by FT_contains*, FT_stat, FT_getFileContents, and the like)
+  return without parsing the path or descending the tree. The filter
+  is kept in sync by every FT operation and is turned off by
+  FT_destroy.
+  Returns SUCCESS if the filter is now in the requested state.
+  Otherwise, returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated to build the filter,
+                 in which case the filter remains off
+*/
+int FT_enableBloomFilter(boolean bEnable);
+
+/*
+  Inserts ulNumPaths new files into the FT: for each i, a file with
+  absolute path apcPaths[i] and contents apvContents[i] of size
+  aulLengths[i] bytes. The files are inserted in tree order, in which
+  each path comes right after its parent's path and before its later
+  siblings' paths, with equal paths kept in their original order. The
+  batch is sorted into that order unless it already is in it, and
+  inserting in that order lets each path resume from the nodes the
+  previous path reached instead of starting at the root.
+  Sets aiStatuses[i] to the status FT_insertFile would return for
+  apcPaths[i] if the files were inserted one at a time in tree order.
+  Returns SUCCESS if the batch was processed. Otherwise, inserts
+  nothing, and sets every aiStatuses[i] to and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated to sort the batch
+*/
+int FT_insertBatch(const char *apcPaths[], void *apvContents[],
+                   const size_t aulLengths[], size_t ulNumPaths,
+                   int aiStatuses[]);
+
+/* The result of looking up one path with FT_statMany */
+struct statResult {
+   /* The status FT_stat would return for the path */
+   int iStatus;
+   /* Whether the path is a file, if iStatus is SUCCESS */
+   boolean bIsFile;
+   /* The file's size, if iStatus is SUCCESS and bIsFile is TRUE */
+   size_t ulSize;
+};
+
+/*
+  Looks up the ulNumPaths absolute paths of apcPaths as FT_stat would,
+  storing the result for apcPaths[i] in asResults[i]. If apcPaths is
+  in tree order (see FT_insertBatch), each path is resolved from where
+  it parts from the previous one, so shared prefixes are searched only
+  once. Otherwise the lookups are interleaved, so that each one's
+  memory accesses overlap the others' work rather than stalling on
+  every level of the FT in turn.
+  Returns SUCCESS if the paths were looked up, or sets every
+  asResults[i].iStatus to and returns INITIALIZATION_ERROR if the FT
+  is not in an initialized state.
+*/
+int FT_statMany(const char *apcPaths[], size_t ulNumPaths,
+                struct statResult asResults[]);
+
+/*
+  Calls (*pfVisit)(pcPath, bIsFile, pvExtra) for each node of the FT
+  whose absolute path pcPath is at least pcStart and less than pcEnd
+  in tree order (see FT_insertBatch), in that order, where bIsFile is
+  TRUE if the node is a file. pcStart and pcEnd need not be in the FT;
+  a NULL pcStart or pcEnd leaves the range unbounded on that side.
+  Only the nodes in the range and the ancestors leading to them are
+  examined, so scanning a small range is fast however large the FT is.
+  pfVisit must not modify the FT.
+  Returns SUCCESS, or INITIALIZATION_ERROR if the FT is not in an
+  initialized state.
+*/
+int FT_scanRange(const char *pcStart, const char *pcEnd,
+                 void (*pfVisit)(const char *pcPath, boolean bIsFile,
+                                 void *pvExtra),
+                 const void *pvExtra);
+
+/*
+  Calls (*pfVisit)(pcPath, bIsFile, pvExtra) for each node of the FT
+  whose absolute path pcPath matches pattern pcPattern, in tree order
+  (see FT_insertBatch), where bIsFile is TRUE if the node is a file.
+  The pattern is matched component by component: "**" matches any
+  number of components, including none, and in any other component
+  '*' matches any string, '?' any one character, and a bracket
+  expression such as "[a-c]" or "[!0-9]" any one character it
+  includes. Components without these are matched by direct lookup,
+  and only subtrees that can still match are searched.
+  pfVisit must not modify the FT.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BAD_PATH if pcPattern is not a well-formatted path, or has more
+             components than the bits in an unsigned long, less one
+*/
+int FT_glob(const char *pcPattern,
+            void (*pfVisit)(const char *pcPath, boolean bIsFile,
+                            void *pvExtra),
+            const void *pvExtra);
+
+/*
+  Builds the FT, which must be empty, from the manifest psManifest: a
+  text stream with one absolute path per line, each followed by a tab
+  and a decimal size if it is a file (whose contents are then NULL),
+  and listed after its parent but before any path outside its
+  parent's subtree. Both FT_toString's order and tree order, as used by
+  FT_insertBatch, qualify, and siblings may come in any order. Returns
+  SUCCESS if every line was added. Otherwise, leaves the FT empty and
+  returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * ALREADY_IN_TREE if the FT is not empty, or a path is listed twice
+  * BAD_PATH if a line is not a well-formatted path and size, or
+             psManifest could not be read to its end
+  * CONFLICTING_PATH if the paths do not share a root, or the root is
+                     a file
+  * NO_SUCH_PATH if a path is not listed after its parent as above
+  * NOT_A_DIRECTORY if a path is listed under a file
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_buildFromManifest(FILE *psManifest);
+
+/*
+  Turns the optional name index on if bEnable is TRUE, or off if it is
+  FALSE. The name index lists the nodes with each final path component,
+  which makes FT_findByName take time proportional to its matches
+  rather than to the FT, at the cost of memory and of keeping it up to
+  date on every insertion and removal. It is off after FT_init.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated to build the index,
+                 in which case it is left off
+*/
+int FT_enableNameIndex(boolean bEnable);
+
+/*
+  Calls (*pfVisit)(pcPath, bIsFile, pvExtra) for each node of the FT
+  whose final path component is pcName, in tree order (see
+  FT_insertBatch), where pcPath is the node's absolute path and
+  bIsFile is TRUE if it is a file. Uses the name index if it is on,
+  and searches the whole FT otherwise. pfVisit must not modify the FT.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BAD_PATH if pcName is empty or contains a '/'
+*/
+int FT_findByName(const char *pcName,
+                  void (*pfVisit)(const char *pcPath, boolean bIsFile,
+                                  void *pvExtra),
+                  const void *pvExtra);
+
+/*
+  An FTDir_T is a handle on a directory of the FT, through which names
+  can be resolved relative to that directory without searching from
+  the root. A handle stays allocated until it is passed to
+  FT_closeDir. Once its directory is removed from the FT (by FT_rmDir
+  on it or an ancestor, or by FT_destroy), the handle is invalid:
+  operations through it return NO_SUCH_PATH (or INITIALIZATION_ERROR
+  if the FT is not initialized), even if a directory with the same
+  path is later inserted.
+*/
+typedef struct dirHandle *FTDir_T;
+
+/*
+  Opens a handle on the directory with absolute path pcPath.
+  Returns SUCCESS and sets *poDResult to the new handle if successful.
+  Otherwise, sets *poDResult to NULL and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BAD_PATH if pcPath does not represent a well-formatted path
+  * CONFLICTING_PATH if the root's path is not a prefix of pcPath
+  * NO_SUCH_PATH if absolute path pcPath does not exist in the FT
+  * NOT_A_DIRECTORY if pcPath is in the FT as a file not a directory
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_openDir(const char *pcPath, FTDir_T *poDResult);
+
+/* Closes and frees handle oDDir, which may be invalid. */
+void FT_closeDir(FTDir_T oDDir);
+
+/*
+  Inserts a new file named pcName into the directory of handle oDDir,
+  with file contents pvContents of size ulLength bytes.
+  Returns SUCCESS if the new file is inserted successfully.
+  Otherwise, returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * NO_SUCH_PATH if oDDir is invalid
+  * BAD_PATH if pcName is empty or contains a '/'
+  * ALREADY_IN_TREE if oDDir's directory already has a child pcName
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_insertFileAt(FTDir_T oDDir, const char *pcName,
+                    void *pvContents, size_t ulLength);
+
+/*
+  Looks up the child named pcName of the directory of handle oDDir.
+  Returns SUCCESS if it exists, setting *pbIsFile and *pulSize as
+  FT_stat does. Otherwise, leaves them unchanged and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * NO_SUCH_PATH if oDDir is invalid or has no child named pcName
+  * BAD_PATH if pcName is empty or contains a '/'
+*/
+int FT_lookupAt(FTDir_T oDDir, const char *pcName,
+                boolean *pbIsFile, size_t *pulSize);
+
+/*
+  Calls (*pfVisit)(pcName, bIsFile, pvExtra) for each child of the
+  directory of handle oDDir, where pcName is the child's name and
+  bIsFile is TRUE if the child is a file. Children are visited in the
+  order FT_toString uses: files before directories, and each kind in
+  lexicographic order. pfVisit must not modify the FT.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * NO_SUCH_PATH if oDDir is invalid
+*/
+int FT_listAt(FTDir_T oDDir,
+              void (*pfVisit)(const char *pcName, boolean bIsFile,
+                              void *pvExtra),
+              const void *pvExtra);
+
+/* An entry of a directory listing from FT_listDir */
+struct dirEntry {
+   /* The entry's name, the final component of its path, which stays
+      valid until the entry is removed from the FT */
+   const char *pcName;
+   /* TRUE if the entry is a file, FALSE if it is a directory */
+   boolean bIsFile;
+};
+
+/*
+  Lists up to ulMaxEntries children of the directory with absolute
+  path pcPath into asEntries, in the order FT_listAt uses, and stores
+  in *pulNumEntries how many were listed. *pulCursor is where to start:
+  0 for the first child, or the value a previous call left in it to
+  continue from there. Each call advances *pulCursor past the entries
+  it lists, and lists fewer than ulMaxEntries only once the listing is
+  complete. A call takes time proportional to the entries it lists
+  and the entries of the other kind it passes over, not to the size
+  of the directory. If the directory changes between calls, entries
+  may be listed twice or not at all.
+  Returns SUCCESS, or otherwise lists nothing and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * BAD_PATH if pcPath does not represent a well-formatted path
+  * CONFLICTING_PATH if the root's path is not a prefix of pcPath
+  * NO_SUCH_PATH if no node with pcPath exists in the hierarchy
+  * NOT_A_DIRECTORY if pcPath is a file
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_listDir(const char *pcPath, size_t *pulCursor,
+               size_t ulMaxEntries, struct dirEntry asEntries[],
+               size_t *pulNumEntries);
+
+/* An entry of a directory listing with stat data, from
+   FT_listDirPlus */
+struct dirEntryPlus {
+   /* The entry's name, as in struct dirEntry */
+   const char *pcName;
+   /* TRUE if the entry is a file, FALSE if it is a directory */
+   boolean bIsFile;
+   /* The size of a file's contents, or 0 for a directory */
+   size_t ulSize;
+   /* The number of children of a directory, or 0 for a file */
+   size_t ulNumChildren;
+};
+
+/*
+  Lists the children of the directory with absolute path pcPath
+  exactly as FT_listDir does, but with each entry's size and number of
+  children as well, saving a separate FT_stat per entry. Returns the
+  same statuses as FT_listDir.
+*/
+int FT_listDirPlus(const char *pcPath, size_t *pulCursor,
+                   size_t ulMaxEntries, struct dirEntryPlus asEntries[],
+                   size_t *pulNumEntries);
+
+/*
+  Freezes the FT: replaces it with a compact read-only copy that keeps
+  every node in one array and every name in one pool, which takes a
+  fraction of the memory and is faster to search. While the FT is
+  frozen, FT_containsDir, FT_containsFile, FT_getFileContents, FT_stat
+  and FT_toString work as before, FT_thaw and FT_destroy end the
+  freeze, and every other function fails as if the FT were not
+  initialized. Open directory handles become invalid.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state,
+                         which includes being frozen already
+  * MEMORY_ERROR if memory could not be allocated for the copy, in
+                 which case the FT is left as it was
+*/
+int FT_freeze(void);
+
+/*
+  Thaws a frozen FT, rebuilding it in its ordinary, changeable form
+  with the same contents and with the same indexes and filter on.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not frozen
+  * MEMORY_ERROR if memory could not be allocated to rebuild the FT,
+                 in which case it stays frozen
+*/
+int FT_thaw(void);
+
+/*
+  Moves nodes of the FT, in the order FT_toString lists them, into
+  large blocks of memory, each directly followed by its pathname, so
+  that walking the FT in that order reads memory from start to end and
+  the holes left by earlier changes are given back. One pass over the
+  FT may be spread over many calls: each call moves at most
+  ulMaxNodes nodes (no limit if ulMaxNodes is 0) and the FT may be
+  changed freely between calls. Sets *pbDone to TRUE
+  when the pass is complete, freeing the blocks of the previous pass,
+  and to FALSE otherwise; the next call then starts or resumes a pass.
+  The component names that paths share (see atom.h) stay where they
+  are; contents and open directory handles are unaffected.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated to move a node, in
+                 which case the nodes moved so far stay moved
+*/
+int FT_compact(size_t ulMaxNodes, boolean *pbDone);
+
+/*
+  Sets *pulSize to the number of bytes of memory holding the FT's
+  nodes that is backed by huge pages. Huge pages are opt-in: inserts
+  allocate nodes one at a time as before, and only the blocks that
+  FT_compact moves nodes into ask for huge pages, so a program must
+  call FT_compact to use them and the count is 0 until it does. It
+  also stays 0 unless the FT was built with ARENA_HUGEPAGES defined
+  (see arena.h), as the Makefile does.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state, in
+                         which case *pulSize is unchanged
+*/
+int FT_getHugePageSize(size_t *pulSize);
+
+/*
+  Gives back memory the FT holds beyond what its current contents
+  need: spare room left in directories' lists of children, and in the
+  FT's own bookkeeping, after removals. Removals already give back
+  room once a list is no more than a quarter full; this releases the
+  rest, for a long-running program to call after a burst of changes.
+  Lists that FT_compact placed are exact when placed, and the room
+  they lose to later removals comes back with the next FT_compact.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+*/
+int FT_trimMemory(void);
+
 /*
   Returns a string representation of the
   data structure, or NULL if the structure is
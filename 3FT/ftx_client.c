@@ -0,0 +1,1232 @@
+/*--------------------------------------------------------------------*/
+/* ftx_client.c                                                       */
+/* Author: John Matters, Daniel Wang                                  */
+/*--------------------------------------------------------------------*/
+
+#ifdef ATOM_THREADSAFE
+#define _POSIX_C_SOURCE 200112L
+#include <pthread.h>
+#endif
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "atom.h"
+#include "dynarray.h"
+#include "dynarrayt.h"
+#include "ft.h"
+#include "path.h"
+
+/* Appends pcName and a marker of whether it is a file to the string
+   pvExtra, for checking the order of a directory listing. */
+static void appendName(const char *pcName, boolean bIsFile,
+                       void *pvExtra) {
+  strcat((char *) pvExtra, pcName);
+  strcat((char *) pvExtra, bIsFile ? "(f) " : "(d) ");
+}
+
+/* Compares integers i1 and i2, returning <0, 0, or >0 if i1 is less
+   than, equal to, or greater than i2, respectively. */
+static int compareInts(int i1, int i2) {
+  return (i1 > i2) - (i1 < i2);
+}
+
+/* A typed array of ints, for testing dynarrayt.h directly */
+DEFINE_DYNARRAY(IntArray, int, compareInts)
+
+/* Compares the ints that pv1 and pv2 point to, as compareInts does,
+   for sorting an untyped DynArray of them. */
+static int compareIntPointers(const void *pv1, const void *pv2) {
+  return compareInts(*(const int *) pv1, *(const int *) pv2);
+}
+
+/* Returns element ul of a sort input of ulCount ints with the shape
+   iShape: 0 ascending, 1 descending, 2 all equal, or 3 rising to the
+   middle and falling again, like organ pipes. */
+static int shapedInt(int iShape, size_t ul, size_t ulCount) {
+  switch(iShape) {
+  case 0:
+    return (int) ul;
+  case 1:
+    return (int) (ulCount - 1 - ul);
+  case 2:
+    return 7;
+  default:
+    return (int) (ul < (ulCount + 1) / 2 ? ul : ulCount - 1 - ul);
+  }
+}
+
+/* Returns element ul of the ulCount ints of shape iShape once they
+   are sorted. */
+static int sortedShapedInt(int iShape, size_t ul) {
+  switch(iShape) {
+  case 2:
+    return 7;
+  case 3:
+    return (int) (ul / 2);
+  default:
+    return (int) ul;
+  }
+}
+
+/* The adversary of M. D. McIlroy, "A Killer Adversary for Quicksort",
+   which compareGas plays against a sort of indices into
+   aiGasValues. An element whose value is still iGas is "gas" and
+   compares above every other; the adversary fixes values one at a
+   time, only as it must, in the order that makes a quicksort's
+   pivots worst. ulNumGasCompares counts the comparisons made. */
+enum {GAS_LENGTH = 2000};
+static int aiGasValues[GAS_LENGTH];
+static int iGas;
+static int iNumSolid;
+static int iGasCandidate;
+static size_t ulNumGasCompares;
+
+/* Starts the adversary over on ulCount elements, all gas. */
+static void startGas(size_t ulCount) {
+  size_t ul;
+
+  iGas = (int) ulCount - 1;
+  iNumSolid = 0;
+  iGasCandidate = 0;
+  ulNumGasCompares = 0;
+  for(ul = 0; ul < ulCount; ul++)
+    aiGasValues[ul] = iGas;
+}
+
+/* Compares the elements at indices i1 and i2 of aiGasValues as the
+   adversary would, fixing a value first if both are gas. */
+static int compareGas(int i1, int i2) {
+  ulNumGasCompares++;
+  if(aiGasValues[i1] == iGas && aiGasValues[i2] == iGas) {
+    if(i1 == iGasCandidate)
+      aiGasValues[i1] = iNumSolid++;
+    else
+      aiGasValues[i2] = iNumSolid++;
+  }
+  if(aiGasValues[i1] == iGas)
+    iGasCandidate = i1;
+  else if(aiGasValues[i2] == iGas)
+    iGasCandidate = i2;
+  return compareInts(aiGasValues[i1], aiGasValues[i2]);
+}
+
+/* Compares the indices that pv1 and pv2 point to as compareGas does,
+   for sorting an untyped DynArray of them. */
+static int compareGasPointers(const void *pv1, const void *pv2) {
+  return compareGas(*(const int *) pv1, *(const int *) pv2);
+}
+
+/* A typed array of indices, sorted against the adversary */
+DEFINE_DYNARRAY(GasArray, int, compareGas)
+
+/* A string key and the position it was added at, for checking that
+   a key sort leaves equal keys in the order of their comparison */
+struct keyed {
+  const char *pcKey;
+  size_t ulIndex;
+};
+
+/* Compares s1 and s2 by key, then by position. */
+static int compareKeyed(struct keyed s1, struct keyed s2) {
+  int iCompare = strcmp(s1.pcKey, s2.pcKey);
+
+  if(iCompare != 0)
+    return iCompare;
+  return (s1.ulIndex > s2.ulIndex) - (s1.ulIndex < s2.ulIndex);
+}
+
+/* The key of a keyed element, and the rank of one of its characters,
+   in strcmp's order */
+#define KEYED_KEY(s) ((s).pcKey)
+#define KEYED_RANK(c) ((int) (unsigned char) (c))
+
+/* A typed array of keyed elements, for testing the key sort */
+DEFINE_DYNARRAY(KeyedArray, struct keyed, compareKeyed)
+DEFINE_DYNARRAY_KEYSORT(KeyedArray, struct keyed, KEYED_KEY,
+                        KEYED_RANK)
+
+/* Stores pcPath in the string pointer that pvExtra points to, for
+   finding where a node's pathname is kept. */
+static void recordPath(const char *pcPath, boolean bIsFile,
+                       void *pvExtra) {
+  assert(bIsFile == TRUE || bIsFile == FALSE);
+  *(const char **) pvExtra = pcPath;
+}
+
+#ifdef ATOM_THREADSAFE
+/* Interns and releases the same few names many times over, for
+   running from several threads at once. Returns pvArg. */
+static void *internNames(void *pvArg) {
+  static const char *apcNames[] = {"2a", "2b", "2c", "2d"};
+  const char *pcAtom;
+  size_t i;
+
+  for(i = 0; i < 20000; i++) {
+    pcAtom = Atom_new(apcNames[i % 4], 2);
+    assert(pcAtom != NULL);
+    assert(!strcmp(pcAtom, apcNames[i % 4]));
+    Atom_release(pcAtom);
+  }
+  return pvArg;
+}
+#endif
+
+/* Tests the extensions to the FT interface beyond the basic
+   insert/contains/remove operations exercised by ft_client.
+   Returns 0. */
+int main(void) {
+  enum {ARRLEN = 1000};
+  boolean bIsFile;
+  size_t l;
+  char *temp;
+  FTDir_T oDDir;
+  FTDir_T oDOther;
+  char arr[ARRLEN];
+  const char *apcBatch[6];
+  void *apvBatch[6];
+  size_t aulBatch[6];
+  int aiBatch[6];
+  char acMany[40][16];
+  const char *apcMany[40];
+  void *apvMany[40];
+  size_t aulMany[40];
+  int aiMany[40];
+  FILE *psManifest;
+  struct statResult asStats[6];
+  struct dirEntry asEntries[2];
+  struct dirEntryPlus asPlus[4];
+  size_t ulCursor;
+  boolean bDone;
+  const char *pcAtom;
+  const char *pcOther;
+  Path_T oPPath1;
+  Path_T oPPath2;
+  IntArray_T oIArray;
+  size_t ulIndex;
+  DynArray_T oDArray;
+  int aiInts[60];
+  void *apvInts[60];
+  static const size_t aulSortLengths[] = {1, 15, 16, 17, 33, 500};
+  size_t ulLength;
+  int iShape;
+  int aiSort[500];
+  int aiGasIndices[GAS_LENGTH];
+  size_t ulLog;
+  char acKeys[400][100];
+  struct keyed asKeyed[400];
+  struct keyed asExpected[400];
+
+  /* The full-path index can only be used on an initialized FT, must
+     give the same answers as the tree itself, and must follow
+     insertions and removals.
+  */
+  assert(FT_enablePathIndex(TRUE) == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("1root/2child/3gkid") == SUCCESS);
+  assert(FT_insertFile("1root/2second/3gfile", "a", 2) == SUCCESS);
+  assert(FT_enablePathIndex(TRUE) == SUCCESS);
+  assert(FT_enablePathIndex(TRUE) == SUCCESS);
+  assert(FT_containsDir("1root/2child/3gkid") == TRUE);
+  assert(FT_containsFile("1root/2second/3gfile") == TRUE);
+  assert(FT_containsDir("1root/2second/3gfile") == FALSE);
+  assert(FT_insertDir("1root/2child") == ALREADY_IN_TREE);
+  assert(FT_insertFile("1root/2child/3gkid/4f", "b", 2) == SUCCESS);
+  assert(FT_stat("1root/2child/3gkid/4f", &bIsFile, &l) == SUCCESS);
+  assert(bIsFile == TRUE);
+  assert(l == 2);
+  assert(FT_stat("1root/2child/3nope", &bIsFile, &l) == NO_SUCH_PATH);
+  assert(FT_stat("1root//2child", &bIsFile, &l) == BAD_PATH);
+  assert(FT_stat("1other/2child", &bIsFile, &l) == CONFLICTING_PATH);
+  assert(FT_rmDir("1root/2child") == SUCCESS);
+  assert(FT_containsDir("1root/2child/3gkid") == FALSE);
+  assert(FT_containsFile("1root/2child/3gkid/4f") == FALSE);
+  assert(FT_insertDir("1root/2child/3gkid") == SUCCESS);
+  assert(FT_containsFile("1root/2child/3gkid/4f") == FALSE);
+  assert(FT_enablePathIndex(FALSE) == SUCCESS);
+  assert(FT_containsDir("1root/2child/3gkid") == TRUE);
+  assert(FT_enablePathIndex(TRUE) == SUCCESS);
+  assert(FT_rmDir("1root") == SUCCESS);
+  assert(FT_containsDir("1root") == FALSE);
+  assert((temp = FT_toString()) != NULL);
+  assert(!strcmp(temp, ""));
+  free(temp);
+  assert(FT_destroy() == SUCCESS);
+
+  /* The negative lookup filter must never hide a path that is in the
+     FT, and paths it filters out must still get the same statuses as
+     an unfiltered lookup.
+  */
+  assert(FT_enableBloomFilter(TRUE) == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_enableBloomFilter(TRUE) == SUCCESS);
+  assert(FT_stat("1root", &bIsFile, &l) == NO_SUCH_PATH);
+  assert(FT_stat("1root/", &bIsFile, &l) == BAD_PATH);
+  assert(FT_insertDir("1root/2child/3gkid") == SUCCESS);
+  assert(FT_insertFile("1root/2second/3gfile", "a", 2) == SUCCESS);
+  assert(FT_containsDir("1root/2child/3gkid") == TRUE);
+  assert(FT_containsFile("1root/2second/3gfile") == TRUE);
+  assert(FT_containsFile("1root/2second/3nope") == FALSE);
+  assert(FT_stat("1root/2second/3nope", &bIsFile, &l) == NO_SUCH_PATH);
+  assert(FT_stat("1roo/2second", &bIsFile, &l) == CONFLICTING_PATH);
+  assert(FT_stat("1rootx/2second", &bIsFile, &l) == CONFLICTING_PATH);
+  assert(FT_stat("", &bIsFile, &l) == BAD_PATH);
+  assert(FT_stat("/1root", &bIsFile, &l) == BAD_PATH);
+  assert(FT_stat("1root//2child", &bIsFile, &l) == BAD_PATH);
+  assert(FT_rmFile("1root/2second/3nope") == NO_SUCH_PATH);
+  assert(FT_rmFile("1root/2second/3gfile") == SUCCESS);
+  assert(FT_containsFile("1root/2second/3gfile") == FALSE);
+  assert(FT_enablePathIndex(TRUE) == SUCCESS);
+  assert(FT_insertFile("1root/2second/3gfile", "b", 2) == SUCCESS);
+  assert(FT_containsFile("1root/2second/3gfile") == TRUE);
+  assert(FT_rmDir("1root") == SUCCESS);
+  assert(FT_containsDir("1root") == FALSE);
+  assert(FT_stat("1root", &bIsFile, &l) == NO_SUCH_PATH);
+  assert(FT_destroy() == SUCCESS);
+
+  /* Repeated operations in one directory start from a remembered
+     directory, which must be forgotten once it is removed.
+  */
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("1root") == SUCCESS);
+  assert(FT_insertFile("1root/2a/3b/4f1", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2a/3b/4f2", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2a/3b/4f3", NULL, 0) == SUCCESS);
+  assert(FT_containsFile("1root/2a/3b/4f2") == TRUE);
+  assert(FT_insertDir("1root/2a/3b/4d/5e") == SUCCESS);
+  assert(FT_containsDir("1root/2a/3b/4d/5e") == TRUE);
+  assert(FT_rmDir("1root/2a/3b") == SUCCESS);
+  assert(FT_containsFile("1root/2a/3b/4f2") == FALSE);
+  assert(FT_containsDir("1root/2a/3b/4d/5e") == FALSE);
+  assert(FT_insertFile("1root/2a/3b/4f2", NULL, 0) == SUCCESS);
+  assert(FT_containsFile("1root/2a/3b/4f2") == TRUE);
+  assert(FT_containsFile("1root/2a/3b/4f1") == FALSE);
+  assert(FT_insertDir("1other/2a") == CONFLICTING_PATH);
+  assert(FT_rmDir("1root") == SUCCESS);
+  assert(FT_insertDir("1other/2a") == SUCCESS);
+  assert(FT_containsDir("1root/2a") == FALSE);
+  assert(FT_containsDir("1other/2a") == TRUE);
+  assert(FT_destroy() == SUCCESS);
+
+  /* Handles resolve names relative to their directory, and become
+     invalid when their directory or one of its ancestors is removed.
+  */
+  assert(FT_openDir("1root", &oDDir) == INITIALIZATION_ERROR);
+  assert(oDDir == NULL);
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("1root/2a/3b") == SUCCESS);
+  assert(FT_insertFile("1root/2a/3f", "c", 2) == SUCCESS);
+  assert(FT_openDir("1root/2a/3f", &oDDir) == NOT_A_DIRECTORY);
+  assert(FT_openDir("1root/2a/3x", &oDDir) == NO_SUCH_PATH);
+  assert(FT_openDir("1root/2a", &oDDir) == SUCCESS);
+  assert(FT_openDir("1root/2a/3b", &oDOther) == SUCCESS);
+  assert(FT_insertFileAt(oDDir, "3g", "d", 2) == SUCCESS);
+  assert(FT_insertFileAt(oDDir, "3g", "d", 2) == ALREADY_IN_TREE);
+  assert(FT_insertFileAt(oDDir, "3b", NULL, 0) == ALREADY_IN_TREE);
+  assert(FT_insertFileAt(oDDir, "", NULL, 0) == BAD_PATH);
+  assert(FT_insertFileAt(oDDir, "3h/4i", NULL, 0) == BAD_PATH);
+  assert(FT_containsFile("1root/2a/3g") == TRUE);
+  assert(FT_lookupAt(oDDir, "3g", &bIsFile, &l) == SUCCESS);
+  assert(bIsFile == TRUE);
+  assert(l == 2);
+  assert(FT_lookupAt(oDDir, "3b", &bIsFile, &l) == SUCCESS);
+  assert(bIsFile == FALSE);
+  assert(FT_lookupAt(oDDir, "3nope", &bIsFile, &l) == NO_SUCH_PATH);
+  arr[0] = '\0';
+  assert(FT_listAt(oDDir, appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "3f(f) 3g(f) 3b(d) "));
+  assert(FT_rmFile("1root/2a/3g") == SUCCESS);
+  assert(FT_lookupAt(oDDir, "3g", &bIsFile, &l) == NO_SUCH_PATH);
+  assert(FT_rmDir("1root/2a") == SUCCESS);
+  assert(FT_lookupAt(oDDir, "3b", &bIsFile, &l) == NO_SUCH_PATH);
+  assert(FT_insertFileAt(oDOther, "4f", NULL, 0) == NO_SUCH_PATH);
+  assert(FT_insertDir("1root/2a/3b") == SUCCESS);
+  assert(FT_listAt(oDDir, appendName, arr) == NO_SUCH_PATH);
+  FT_closeDir(oDOther);
+  assert(FT_openDir("1root/2a", &oDOther) == SUCCESS);
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_lookupAt(oDOther, "3b", &bIsFile, &l) ==
+         INITIALIZATION_ERROR);
+  FT_closeDir(oDDir);
+  FT_closeDir(oDOther);
+
+  /* A batch gets the statuses of inserting its files one at a time in
+     tree order, whatever order the caller gives them in.
+  */
+  apcBatch[0] = "1root/2b/3f";
+  apcBatch[1] = "1root/2a/3f";
+  apcBatch[2] = "1root/2a";
+  apcBatch[3] = "1root/2a/3f";
+  apcBatch[4] = "1root//2c";
+  apcBatch[5] = "1other/2d";
+  for(l = 0; l < 6; l++) {
+    apvBatch[l] = "e";
+    aulBatch[l] = l;
+  }
+  assert(FT_insertBatch(apcBatch, apvBatch, aulBatch, 6, aiBatch) ==
+         INITIALIZATION_ERROR);
+  assert(aiBatch[0] == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("1root") == SUCCESS);
+  assert(FT_insertBatch(apcBatch, apvBatch, aulBatch, 6, aiBatch) ==
+         SUCCESS);
+  assert(aiBatch[0] == SUCCESS);
+  assert(aiBatch[1] == NOT_A_DIRECTORY);
+  assert(aiBatch[2] == SUCCESS);
+  assert(aiBatch[3] == NOT_A_DIRECTORY);
+  assert(aiBatch[4] == BAD_PATH);
+  assert(aiBatch[5] == CONFLICTING_PATH);
+  assert(FT_stat("1root/2a", &bIsFile, &l) == SUCCESS);
+  assert(bIsFile == TRUE);
+  assert(l == 2);
+  assert(FT_containsFile("1root/2b/3f") == TRUE);
+  apcBatch[0] = "1root/2c/3a";
+  apcBatch[1] = "1root/2c/3b";
+  apcBatch[2] = "1root/2c/3b";
+  apcBatch[3] = "1root/2c.d";
+  assert(FT_insertBatch(apcBatch, apvBatch, aulBatch, 4, aiBatch) ==
+         SUCCESS);
+  assert(aiBatch[0] == SUCCESS);
+  assert(aiBatch[1] == SUCCESS);
+  assert(aiBatch[2] == ALREADY_IN_TREE);
+  assert(aiBatch[3] == SUCCESS);
+  assert(FT_stat("1root/2c/3b", &bIsFile, &l) == SUCCESS);
+  assert(l == 1);
+  assert(FT_insertBatch(apcBatch, apvBatch, aulBatch, 0, aiBatch) ==
+         SUCCESS);
+  assert(FT_destroy() == SUCCESS);
+
+  /* A manifest in FT_toString's order, or any order that lists each
+     path after its parent, builds the same FT as inserting its paths.
+  */
+  assert((psManifest = tmpfile()) != NULL);
+  fputs("1root\n1root/2b\t3\n1root/2a\n1root/2a/3x\t0\n"
+        "1root/2c\n1root/2c/3y\n1root/2a.d\n", psManifest);
+  rewind(psManifest);
+  assert(FT_buildFromManifest(psManifest) == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_enablePathIndex(TRUE) == SUCCESS);
+  assert(FT_buildFromManifest(psManifest) == SUCCESS);
+  assert(FT_stat("1root/2b", &bIsFile, &l) == SUCCESS);
+  assert(bIsFile == TRUE);
+  assert(l == 3);
+  assert(FT_containsDir("1root/2c/3y") == TRUE);
+  assert(FT_containsFile("1root/2a/3x") == TRUE);
+  assert((temp = FT_toString()) != NULL);
+  assert(!strcmp(temp, "1root\n1root/2b\n1root/2a\n1root/2a/3x\n"
+                 "1root/2a.d\n1root/2c\n1root/2c/3y\n"));
+  free(temp);
+  assert(FT_insertFile("1root/2a/3w", NULL, 0) == SUCCESS);
+  assert(FT_insertDir("1root/2c/3y") == ALREADY_IN_TREE);
+  rewind(psManifest);
+  assert(FT_buildFromManifest(psManifest) == ALREADY_IN_TREE);
+  assert(FT_destroy() == SUCCESS);
+  fclose(psManifest);
+
+  assert(FT_init() == SUCCESS);
+  assert((psManifest = tmpfile()) != NULL);
+  fputs("1root\n1root/2a\n1root/2b\n1root/2a/3c\n", psManifest);
+  rewind(psManifest);
+  assert(FT_buildFromManifest(psManifest) == NO_SUCH_PATH);
+  assert(FT_containsDir("1root") == FALSE);
+  fclose(psManifest);
+  assert((psManifest = tmpfile()) != NULL);
+  fputs("1root\n1root/2a\t1\n1root/2a/3c\n", psManifest);
+  rewind(psManifest);
+  assert(FT_buildFromManifest(psManifest) == NOT_A_DIRECTORY);
+  fclose(psManifest);
+  assert((psManifest = tmpfile()) != NULL);
+  fputs("1root\n1root/2a\n1root/2b\n1root/2a\t1\n", psManifest);
+  rewind(psManifest);
+  assert(FT_buildFromManifest(psManifest) == ALREADY_IN_TREE);
+  fclose(psManifest);
+  assert((psManifest = tmpfile()) != NULL);
+  fputs("1root\n1root/2a\tx\n", psManifest);
+  rewind(psManifest);
+  assert(FT_buildFromManifest(psManifest) == BAD_PATH);
+  fclose(psManifest);
+  assert((psManifest = tmpfile()) != NULL);
+  fputs("1root\n1other/2a\n", psManifest);
+  rewind(psManifest);
+  assert(FT_buildFromManifest(psManifest) == CONFLICTING_PATH);
+  assert((temp = FT_toString()) != NULL);
+  assert(!strcmp(temp, ""));
+  free(temp);
+  fclose(psManifest);
+
+  /* A manifest that fails while directories with pending children
+     are still open frees them all, and sizes that are empty, have
+     trailing characters, or overflow are rejected, as is a stream
+     that cannot be read, rather than passing for an empty manifest.
+  */
+  assert((psManifest = tmpfile()) != NULL);
+  fputs("1root\n1root/2a\n1root/2a/3x\t5\n1bad//path\n", psManifest);
+  rewind(psManifest);
+  assert(FT_buildFromManifest(psManifest) == BAD_PATH);
+  fclose(psManifest);
+  assert((psManifest = tmpfile()) != NULL);
+  fputs("1root\n1root/2a\n1root/2a/3x\t\n", psManifest);
+  rewind(psManifest);
+  assert(FT_buildFromManifest(psManifest) == BAD_PATH);
+  fclose(psManifest);
+  assert((psManifest = tmpfile()) != NULL);
+  fputs("1root\n1root/2a\n1root/2a/3x\t5x\n", psManifest);
+  rewind(psManifest);
+  assert(FT_buildFromManifest(psManifest) == BAD_PATH);
+  fclose(psManifest);
+  assert((psManifest = tmpfile()) != NULL);
+  fputs("1root\n1root/2a\t99999999999999999999999999\n", psManifest);
+  rewind(psManifest);
+  assert(FT_buildFromManifest(psManifest) == BAD_PATH);
+  fclose(psManifest);
+  /* reading a directory fails on Linux, where it can be opened */
+  psManifest = fopen(".", "r");
+  if(psManifest != NULL) {
+    assert(FT_buildFromManifest(psManifest) == BAD_PATH);
+    fclose(psManifest);
+  }
+  assert((temp = FT_toString()) != NULL);
+  assert(!strcmp(temp, ""));
+  free(temp);
+  assert(FT_destroy() == SUCCESS);
+
+  /* Interleaved lookups give each path the result FT_stat gives. */
+  apcBatch[0] = "1root/2a/3b";
+  apcBatch[1] = "1root/2f";
+  apcBatch[2] = "1root/2a/3x";
+  apcBatch[3] = "1root";
+  apcBatch[4] = "1root/2f/3g";
+  apcBatch[5] = "1root/2a/";
+  assert(FT_statMany(apcBatch, 6, asStats) == INITIALIZATION_ERROR);
+  assert(asStats[5].iStatus == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_statMany(apcBatch, 6, asStats) == SUCCESS);
+  assert(asStats[3].iStatus == NO_SUCH_PATH);
+  assert(asStats[5].iStatus == BAD_PATH);
+  assert(FT_insertDir("1root/2a/3b/4c") == SUCCESS);
+  assert(FT_insertFile("1root/2f", "g", 2) == SUCCESS);
+  assert(FT_statMany(apcBatch, 6, asStats) == SUCCESS);
+  assert(asStats[0].iStatus == SUCCESS);
+  assert(asStats[0].bIsFile == FALSE);
+  assert(asStats[1].iStatus == SUCCESS);
+  assert(asStats[1].bIsFile == TRUE);
+  assert(asStats[1].ulSize == 2);
+  assert(asStats[2].iStatus == NO_SUCH_PATH);
+  assert(asStats[3].iStatus == SUCCESS);
+  assert(asStats[3].bIsFile == FALSE);
+  assert(asStats[4].iStatus == NO_SUCH_PATH);
+  assert(asStats[5].iStatus == BAD_PATH);
+  apcBatch[0] = "1other/2a";
+  apcBatch[1] = "1roo";
+  assert(FT_statMany(apcBatch, 2, asStats) == SUCCESS);
+  assert(asStats[0].iStatus == CONFLICTING_PATH);
+  assert(asStats[1].iStatus == CONFLICTING_PATH);
+  apcBatch[0] = "1root";
+  apcBatch[1] = "1root/2a/3b";
+  apcBatch[2] = "1root/2a/3b/4c";
+  apcBatch[3] = "1root/2a/3b/4d";
+  apcBatch[4] = "1root/2a/3b//4e";
+  apcBatch[5] = "1root/2f";
+  assert(FT_statMany(apcBatch, 6, asStats) == SUCCESS);
+  assert(asStats[0].iStatus == SUCCESS);
+  assert(asStats[1].iStatus == SUCCESS);
+  assert(asStats[2].iStatus == SUCCESS);
+  assert(asStats[2].bIsFile == FALSE);
+  assert(asStats[3].iStatus == NO_SUCH_PATH);
+  assert(asStats[4].iStatus == BAD_PATH);
+  assert(asStats[5].iStatus == SUCCESS);
+  assert(asStats[5].bIsFile == TRUE);
+  assert(FT_destroy() == SUCCESS);
+
+  /* Pages of a listing resume where the previous page stopped, and
+     together list every child once, files first.
+  */
+  assert(FT_listDir("1root", &ulCursor, 2, asEntries, &l) ==
+         INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("1root/2d") == SUCCESS);
+  assert(FT_insertFile("1root/2e", NULL, 0) == SUCCESS);
+  assert(FT_insertDir("1root/2a") == SUCCESS);
+  assert(FT_insertFile("1root/2c", NULL, 0) == SUCCESS);
+  assert(FT_insertDir("1root/2b") == SUCCESS);
+  ulCursor = 0;
+  assert(FT_listDir("1root/2e", &ulCursor, 2, asEntries, &l) ==
+         NOT_A_DIRECTORY);
+  assert(FT_listDir("1root/2x", &ulCursor, 2, asEntries, &l) ==
+         NO_SUCH_PATH);
+  assert(FT_listDir("1root", &ulCursor, 2, asEntries, &l) == SUCCESS);
+  assert(l == 2);
+  assert(!strcmp(asEntries[0].pcName, "2c"));
+  assert(asEntries[0].bIsFile == TRUE);
+  assert(!strcmp(asEntries[1].pcName, "2e"));
+  assert(FT_listDir("1root", &ulCursor, 2, asEntries, &l) == SUCCESS);
+  assert(l == 2);
+  assert(!strcmp(asEntries[0].pcName, "2a"));
+  assert(asEntries[0].bIsFile == FALSE);
+  assert(!strcmp(asEntries[1].pcName, "2b"));
+  assert(FT_listDir("1root", &ulCursor, 2, asEntries, &l) == SUCCESS);
+  assert(l == 1);
+  assert(!strcmp(asEntries[0].pcName, "2d"));
+  assert(FT_listDir("1root", &ulCursor, 2, asEntries, &l) == SUCCESS);
+  assert(l == 0);
+  ulCursor = 0;
+  assert(FT_listDir("1root/2a", &ulCursor, 2, asEntries, &l) ==
+         SUCCESS);
+  assert(l == 0);
+
+  /* Listing with stat data gives what FT_stat would for each entry. */
+  assert(FT_insertFile("1root/2a/3f", NULL, 7) == SUCCESS);
+  assert(FT_insertDir("1root/2a/3g") == SUCCESS);
+  ulCursor = 0;
+  assert(FT_listDirPlus("1root/2c", &ulCursor, 4, asPlus, &l) ==
+         NOT_A_DIRECTORY);
+  assert(FT_listDirPlus("1root", &ulCursor, 3, asPlus, &l) ==
+         SUCCESS);
+  assert(l == 3);
+  assert(!strcmp(asPlus[0].pcName, "2c"));
+  assert(asPlus[0].bIsFile == TRUE);
+  assert(asPlus[0].ulSize == 0);
+  assert(!strcmp(asPlus[2].pcName, "2a"));
+  assert(asPlus[2].bIsFile == FALSE);
+  assert(asPlus[2].ulNumChildren == 2);
+  assert(FT_listDirPlus("1root", &ulCursor, 4, asPlus, &l) ==
+         SUCCESS);
+  assert(l == 2);
+  assert(!strcmp(asPlus[1].pcName, "2d"));
+  assert(asPlus[1].ulNumChildren == 0);
+  ulCursor = 0;
+  assert(FT_listDirPlus("1root/2a", &ulCursor, 4, asPlus, &l) ==
+         SUCCESS);
+  assert(l == 2);
+  assert(asPlus[0].ulSize == 7);
+  assert(asPlus[0].ulNumChildren == 0);
+  assert(FT_destroy() == SUCCESS);
+
+  /* A range scan lists exactly the paths between its bounds, in tree
+     order, whether or not the bounds are in the FT.
+  */
+  assert(FT_scanRange(NULL, NULL, appendName, arr) ==
+         INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  arr[0] = '\0';
+  assert(FT_scanRange(NULL, NULL, appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, ""));
+  assert(FT_insertDir("1root/2a/3b") == SUCCESS);
+  assert(FT_insertFile("1root/2a/3c", NULL, 0) == SUCCESS);
+  assert(FT_insertDir("1root/2a-x") == SUCCESS);
+  assert(FT_insertDir("1root/2b/3d") == SUCCESS);
+  assert(FT_scanRange(NULL, NULL, appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "1root(d) 1root/2a(d) 1root/2a/3b(d) "
+                 "1root/2a/3c(f) 1root/2a-x(d) 1root/2b(d) "
+                 "1root/2b/3d(d) "));
+  arr[0] = '\0';
+  assert(FT_scanRange("1root/2a/3bb", "1root/2b/3d", appendName, arr)
+         == SUCCESS);
+  assert(!strcmp(arr, "1root/2a/3c(f) 1root/2a-x(d) 1root/2b(d) "));
+  arr[0] = '\0';
+  assert(FT_scanRange("1root/2a", "1root/2a-x", appendName, arr) ==
+         SUCCESS);
+  assert(!strcmp(arr, "1root/2a(d) 1root/2a/3b(d) 1root/2a/3c(f) "));
+  arr[0] = '\0';
+  assert(FT_scanRange("1root/2c", NULL, appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, ""));
+  assert(FT_destroy() == SUCCESS);
+
+  /* Globs match component by component, with "**" spanning any
+     number of levels, and list each match once, in tree order.
+  */
+  assert(FT_glob("1root/*", appendName, arr) == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("1root") == SUCCESS);
+  assert(FT_insertFile("1root/2a/3logs/4x.gz", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2a/3logs/4y.txt", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2b/3logs/4z.gz", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2b/3logs/4old/5w.gz", NULL, 0) ==
+         SUCCESS);
+  assert(FT_glob("1root//2a", appendName, arr) == BAD_PATH);
+  assert(FT_glob("", appendName, arr) == BAD_PATH);
+  arr[0] = '\0';
+  assert(FT_glob("1root/*/3logs/*.gz", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "1root/2a/3logs/4x.gz(f) "
+                 "1root/2b/3logs/4z.gz(f) "));
+  arr[0] = '\0';
+  assert(FT_glob("1root/**/*.gz", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "1root/2a/3logs/4x.gz(f) "
+                 "1root/2b/3logs/4old/5w.gz(f) "
+                 "1root/2b/3logs/4z.gz(f) "));
+  arr[0] = '\0';
+  assert(FT_glob("1root/**/**/3logs", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "1root/2a/3logs(d) 1root/2b/3logs(d) "));
+  arr[0] = '\0';
+  assert(FT_glob("1root/2[!a]/3logs/4?.gz", appendName, arr) ==
+         SUCCESS);
+  assert(!strcmp(arr, "1root/2b/3logs/4z.gz(f) "));
+  arr[0] = '\0';
+  assert(FT_glob("1other/**", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, ""));
+  assert(FT_destroy() == SUCCESS);
+
+  /* Name lookups report every node with the name, in tree order,
+     whether or not the name index is on, and the index follows
+     insertions and removals.
+  */
+  assert(FT_findByName("3logs", appendName, arr) ==
+         INITIALIZATION_ERROR);
+  assert(FT_enableNameIndex(TRUE) == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("1root") == SUCCESS);
+  assert(FT_insertFile("1root/2b/3logs/4x", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2a/3logs", NULL, 0) == SUCCESS);
+  assert(FT_findByName("2a/3logs", appendName, arr) == BAD_PATH);
+  assert(FT_findByName("", appendName, arr) == BAD_PATH);
+  arr[0] = '\0';
+  assert(FT_findByName("3logs", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "1root/2a/3logs(f) 1root/2b/3logs(d) "));
+  assert(FT_enableNameIndex(TRUE) == SUCCESS);
+  assert(FT_insertDir("1root/2a-c/3logs") == SUCCESS);
+  arr[0] = '\0';
+  assert(FT_findByName("3logs", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "1root/2a/3logs(f) 1root/2a-c/3logs(d) "
+                 "1root/2b/3logs(d) "));
+  assert(FT_rmDir("1root/2b") == SUCCESS);
+  arr[0] = '\0';
+  assert(FT_findByName("3logs", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "1root/2a/3logs(f) 1root/2a-c/3logs(d) "));
+  arr[0] = '\0';
+  assert(FT_findByName("4x", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, ""));
+  assert(FT_enableNameIndex(FALSE) == SUCCESS);
+  arr[0] = '\0';
+  assert(FT_findByName("1root", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "1root(d) "));
+  assert(FT_enableNameIndex(TRUE) == SUCCESS);
+  assert(FT_destroy() == SUCCESS);
+
+  /* Equal strings are interned as one atom, which lives until its
+     last reference is released, so paths share equal components and
+     can compare them by address. A destroyed FT holds no atoms.
+  */
+  assert(Atom_getCount() == 0);
+  pcAtom = Atom_new("2shared", 7);
+  assert(pcAtom != NULL);
+  assert(!strcmp(pcAtom, "2shared"));
+  assert(Atom_getLength(pcAtom) == 7);
+  assert(Atom_getCount() == 1);
+  assert(Atom_new("2shared/3x", 7) == pcAtom);
+  assert(Atom_retain(pcAtom) == pcAtom);
+  assert(Atom_getCount() == 1);
+  pcOther = Atom_new("2shared", 6);
+  assert(pcOther != NULL && pcOther != pcAtom);
+  assert(Atom_getCount() == 2);
+  Atom_release(pcOther);
+  assert(Atom_getCount() == 1);
+  Atom_release(pcAtom);
+  Atom_release(pcAtom);
+  assert(Atom_getCount() == 1);
+  assert(Path_new("1root/2shared/3a", &oPPath1) == SUCCESS);
+  assert(Path_new("1root/2shared/3b", &oPPath2) == SUCCESS);
+  assert(Atom_getCount() == 4);
+  assert(Path_getComponent(oPPath1, 1) == pcAtom);
+  assert(Path_getComponent(oPPath2, 1) == pcAtom);
+  assert(Path_getComponent(oPPath1, 2) !=
+         Path_getComponent(oPPath2, 2));
+  assert(Path_getSharedPrefixDepth(oPPath1, oPPath2) == 2);
+  assert(Path_getSharedPrefixDepth(oPPath1, oPPath1) == 3);
+  Atom_release(pcAtom);
+  assert(Atom_getCount() == 4);
+  Path_free(oPPath1);
+  assert(Atom_getCount() == 3);
+  Path_free(oPPath2);
+  assert(Atom_getCount() == 0);
+#ifdef ATOM_THREADSAFE
+  {
+    pthread_t asThreads[4];
+
+    pcAtom = Atom_new("2a", 2);
+    assert(pcAtom != NULL);
+    for(l = 0; l < 4; l++)
+      assert(pthread_create(&asThreads[l], NULL, internNames, NULL)
+             == 0);
+    for(l = 0; l < 4; l++)
+      assert(pthread_join(asThreads[l], NULL) == 0);
+    assert(Atom_getCount() == 1);
+    assert(Atom_new("2a", 2) == pcAtom);
+    Atom_release(pcAtom);
+    Atom_release(pcAtom);
+    assert(Atom_getCount() == 0);
+  }
+#endif
+
+  /* Lookups that cross, leave, or stop within a chain of only
+     children find the same nodes as ones that search level by level,
+     as the chain grows, splits, and shrinks.
+  */
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("1root/2a/3b/4c/5d") == SUCCESS);
+  assert(FT_containsDir("1root/2a/3b/4c/5d"));
+  assert(FT_containsDir("1root/2a/3b"));
+  assert(!FT_containsDir("1root/2a/3x/4c"));
+  assert(FT_insertFile("1root/2a/3b/4c/5d/6e", NULL, 0) == SUCCESS);
+  assert(FT_containsFile("1root/2a/3b/4c/5d/6e"));
+  assert(FT_insertFile("1root/2a/3b/4c/5d/6e/7f", NULL, 0) ==
+         NOT_A_DIRECTORY);
+  assert(FT_insertDir("1root/2a/3b/4x") == SUCCESS);
+  assert(FT_containsFile("1root/2a/3b/4c/5d/6e"));
+  assert(FT_containsDir("1root/2a/3b/4x"));
+  assert(FT_rmDir("1root/2a/3b/4c") == SUCCESS);
+  assert(!FT_containsFile("1root/2a/3b/4c/5d/6e"));
+  assert(FT_insertDir("1root/2a/3b/4x/5y") == SUCCESS);
+  assert(FT_containsDir("1root/2a/3b/4x/5y"));
+  assert(!FT_containsDir("1root/2a/3b/4x/5y/6z"));
+  assert(FT_insertFile("1root/2a/3b/4x/5y/6z", NULL, 0) == SUCCESS);
+  assert(FT_containsFile("1root/2a/3b/4x/5y/6z"));
+  assert(FT_destroy() == SUCCESS);
+
+  /* A frozen FT answers reads exactly as the live one did, refuses
+     changes, and thaws back to the same tree with its indexes.
+  */
+  assert(FT_freeze() == INITIALIZATION_ERROR);
+  assert(FT_thaw() == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_enablePathIndex(TRUE) == SUCCESS);
+  assert(FT_insertDir("1root") == SUCCESS);
+  assert(FT_insertFile("1root/2b/3f", arr, 7) == SUCCESS);
+  assert(FT_insertDir("1root/2a/3d") == SUCCESS);
+  assert(FT_insertFile("1root/2c", NULL, 0) == SUCCESS);
+  temp = FT_toString();
+  assert(temp != NULL);
+  assert(FT_freeze() == SUCCESS);
+  assert(FT_freeze() == INITIALIZATION_ERROR);
+  assert(FT_init() == INITIALIZATION_ERROR);
+  assert(FT_insertDir("1root/2e") == INITIALIZATION_ERROR);
+  assert(FT_rmFile("1root/2c") == INITIALIZATION_ERROR);
+  assert(FT_containsDir("1root/2a/3d"));
+  assert(!FT_containsDir("1root/2b/3f"));
+  assert(FT_containsFile("1root/2b/3f"));
+  assert(!FT_containsFile("1root/2b/3f/4x"));
+  assert(FT_getFileContents("1root/2b/3f") == arr);
+  assert(FT_getFileContents("1root/2a") == NULL);
+  assert(FT_stat("1root/2b/3f", &bIsFile, &l) == SUCCESS);
+  assert(bIsFile && l == 7);
+  assert(FT_stat("1root/2b", &bIsFile, &l) == SUCCESS);
+  assert(!bIsFile);
+  assert(FT_stat("1root/2b/3", &bIsFile, &l) == NO_SUCH_PATH);
+  assert(FT_stat("1root/2b/", &bIsFile, &l) == BAD_PATH);
+  assert(FT_stat("1other/2b", &bIsFile, &l) == CONFLICTING_PATH);
+  {
+    char *pcFrozen = FT_toString();
+    assert(pcFrozen != NULL && !strcmp(pcFrozen, temp));
+    free(pcFrozen);
+  }
+  assert(FT_thaw() == SUCCESS);
+  assert(FT_thaw() == INITIALIZATION_ERROR);
+  {
+    char *pcThawed = FT_toString();
+    assert(pcThawed != NULL && !strcmp(pcThawed, temp));
+    free(pcThawed);
+  }
+  free(temp);
+  assert(FT_getFileContents("1root/2b/3f") == arr);
+  assert(FT_insertDir("1root/2a/3d/4e") == SUCCESS);
+  assert(FT_containsDir("1root/2a/3d/4e"));
+  assert(FT_freeze() == SUCCESS);
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_containsDir("1root/2a") == FALSE);
+  assert(FT_init() == SUCCESS);
+  assert(FT_freeze() == SUCCESS);
+  assert(!FT_containsDir("1root"));
+  assert(FT_stat("1root", &bIsFile, &l) == NO_SUCH_PATH);
+  temp = FT_toString();
+  assert(temp != NULL && !strcmp(temp, ""));
+  free(temp);
+  assert(FT_thaw() == SUCCESS);
+  assert(FT_insertDir("1root") == SUCCESS);
+  assert(FT_destroy() == SUCCESS);
+
+  /* Searches of a large frozen directory, which are laid out for
+     locality rather than in order, find every child and no others,
+     and the directory lists and thaws in order.
+  */
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("1root") == SUCCESS);
+  for(l = 0; l < 300; l++) {
+    sprintf(arr, "1root/2longname%03lu", (unsigned long) (l * 7 % 300));
+    assert(FT_insertFile(arr, NULL, l) == SUCCESS);
+  }
+  temp = FT_toString();
+  assert(temp != NULL);
+  assert(FT_freeze() == SUCCESS);
+  for(l = 0; l < 300; l++) {
+    sprintf(arr, "1root/2longname%03lu", (unsigned long) l);
+    assert(FT_containsFile(arr));
+    strcat(arr, "x");
+    assert(!FT_containsFile(arr));
+  }
+  assert(!FT_containsFile("1root/2longname"));
+  assert(!FT_containsFile("1root/2a"));
+  assert(!FT_containsFile("1root/3"));
+  {
+    char *pcFrozen = FT_toString();
+    assert(pcFrozen != NULL && !strcmp(pcFrozen, temp));
+    free(pcFrozen);
+  }
+  assert(FT_thaw() == SUCCESS);
+  {
+    char *pcThawed = FT_toString();
+    assert(pcThawed != NULL && !strcmp(pcThawed, temp));
+    free(pcThawed);
+  }
+  free(temp);
+  assert(FT_destroy() == SUCCESS);
+
+  /* Compaction moves nodes without changing the FT, whether a pass is
+     done at once or in slices with changes in between, and open
+     handles and indexes follow the moved nodes.
+  */
+  assert(FT_compact(0, &bDone) == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_enablePathIndex(TRUE) == SUCCESS);
+  assert(FT_enableNameIndex(TRUE) == SUCCESS);
+  assert(FT_insertDir("1root") == SUCCESS);
+  assert(FT_insertFile("1root/2a/3f", arr, 3) == SUCCESS);
+  assert(FT_insertDir("1root/2a/3d/4e") == SUCCESS);
+  assert(FT_insertDir("1root/2b/3c") == SUCCESS);
+  assert(FT_insertFile("1root/2c/3f", NULL, 0) == SUCCESS);
+  assert(FT_openDir("1root/2a/3d", &oDDir) == SUCCESS);
+  assert(FT_compact(2, &bDone) == SUCCESS);
+  assert(!bDone);
+  assert(FT_insertFile("1root/2a/3d/4f", NULL, 1) == SUCCESS);
+  assert(FT_compact(2, &bDone) == SUCCESS);
+  assert(!bDone);
+  assert(FT_rmDir("1root/2b") == SUCCESS);
+  assert(FT_insertDir("1root/2d") == SUCCESS);
+  do
+    assert(FT_compact(2, &bDone) == SUCCESS);
+  while(!bDone);
+  temp = FT_toString();
+  assert(temp != NULL);
+  assert(FT_compact(0, &bDone) == SUCCESS);
+  assert(bDone);
+  {
+    char *pcCompacted = FT_toString();
+    assert(pcCompacted != NULL && !strcmp(pcCompacted, temp));
+    free(pcCompacted);
+  }
+  free(temp);
+  assert(FT_getFileContents("1root/2a/3f") == arr);
+  assert(FT_lookupAt(oDDir, "4f", &bIsFile, &l) == SUCCESS);
+  assert(bIsFile && l == 1);
+  assert(FT_insertFileAt(oDDir, "4g", NULL, 0) == SUCCESS);
+  assert(FT_containsFile("1root/2a/3d/4g"));
+  arr[0] = '\0';
+  assert(FT_findByName("3f", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "1root/2a/3f(f) 1root/2c/3f(f) "));
+  FT_closeDir(oDDir);
+  assert(FT_compact(1, &bDone) == SUCCESS);
+  assert(FT_getHugePageSize(&l) == SUCCESS);
+#ifdef ARENA_HUGEPAGES
+  /* the pass completed above left its arena in use */
+  assert(l > 0);
+#endif
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_getHugePageSize(&l) == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_getHugePageSize(&l) == SUCCESS);
+  assert(l == 0);
+  assert(FT_compact(0, &bDone) == SUCCESS);
+  assert(bDone);
+  assert(FT_destroy() == SUCCESS);
+
+  /* After a pass, pathnames lie in memory in the order FT_toString
+     lists their nodes, files before directories in each directory,
+     however they were inserted.
+  */
+  assert(FT_init() == SUCCESS);
+  assert(FT_enableNameIndex(TRUE) == SUCCESS);
+  assert(FT_insertDir("1root/2c") == SUCCESS);
+  assert(FT_insertDir("1root/2a/3y") == SUCCESS);
+  assert(FT_insertFile("1root/2a/3x", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2d", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2b", NULL, 0) == SUCCESS);
+  assert((temp = FT_toString()) != NULL);
+  assert(!strcmp(temp, "1root\n1root/2b\n1root/2d\n1root/2a\n"
+                 "1root/2a/3x\n1root/2a/3y\n1root/2c\n"));
+  free(temp);
+  assert(FT_compact(0, &bDone) == SUCCESS);
+  assert(bDone);
+  apcBatch[0] = "1root";
+  apcBatch[1] = "2b";
+  apcBatch[2] = "2d";
+  apcBatch[3] = "2a";
+  apcBatch[4] = "3x";
+  apcBatch[5] = "3y";
+  pcOther = NULL;
+  for(l = 0; l < 6; l++) {
+    pcAtom = NULL;
+    assert(FT_findByName(apcBatch[l], recordPath, &pcAtom) == SUCCESS);
+    assert(pcAtom != NULL);
+    assert(pcOther == NULL || pcOther < pcAtom);
+    pcOther = pcAtom;
+  }
+  assert(FT_destroy() == SUCCESS);
+
+  /* A typed array searches as DynArray_bsearch does: it finds each
+     element it holds, and otherwise gives the index at which to
+     insert the sought one to keep the array sorted, even when empty.
+  */
+  oIArray = IntArray_new(0);
+  assert(oIArray != NULL);
+  ulIndex = 1;
+  assert(!IntArray_bsearch(oIArray, 5, &ulIndex));
+  assert(ulIndex == 0);
+  for(l = 0; l < 10; l++)
+    assert(IntArray_add(oIArray, (int) (2 * l + 1)));
+  assert(IntArray_getLength(oIArray) == 10);
+  for(l = 0; l < 10; l++) {
+    assert(IntArray_bsearch(oIArray, (int) (2 * l + 1), &ulIndex));
+    assert(ulIndex == l);
+    assert(!IntArray_bsearch(oIArray, (int) (2 * l), &ulIndex));
+    assert(ulIndex == l);
+  }
+  assert(!IntArray_bsearch(oIArray, 20, &ulIndex));
+  assert(ulIndex == 10);
+  assert(IntArray_addAt(oIArray, ulIndex, 20));
+  assert(IntArray_get(oIArray, 10) == 20);
+  assert(IntArray_set(oIArray, 0, 0) == 1);
+  assert(IntArray_removeAt(oIArray, 1) == 3);
+  assert(!IntArray_bsearch(oIArray, 3, &ulIndex));
+  assert(ulIndex == 1);
+  assert(IntArray_bsearch(oIArray, 0, &ulIndex));
+  assert(ulIndex == 0);
+  assert(IntArray_getLength(oIArray) == 10);
+  IntArray_free(oIArray);
+
+  /* Runs of elements go in and come out whole at the front, middle,
+     and end of an array, an empty run changes nothing, and a run
+     longer than the room left grows the array to hold it.
+  */
+  for(l = 0; l < 60; l++) {
+    aiInts[l] = (int) l;
+    apvInts[l] = &aiInts[l];
+  }
+  oDArray = DynArray_new(0);
+  assert(oDArray != NULL);
+  assert(DynArray_addRangeAt(oDArray, 0, apvInts, 0));
+  assert(DynArray_getLength(oDArray) == 0);
+  assert(DynArray_addRangeAt(oDArray, 0, apvInts + 20, 20));
+  assert(DynArray_addRangeAt(oDArray, 0, apvInts, 10));
+  assert(DynArray_addRangeAt(oDArray, 10, apvInts + 10, 10));
+  assert(DynArray_addRangeAt(oDArray, 40, apvInts + 40, 20));
+  assert(DynArray_addRangeAt(oDArray, 30, apvInts, 0));
+  assert(DynArray_getLength(oDArray) == 60);
+  for(l = 0; l < 60; l++)
+    assert(DynArray_get(oDArray, l) == apvInts[l]);
+  DynArray_removeRange(oDArray, 0, 5);
+  DynArray_removeRange(oDArray, 10, 0);
+  DynArray_removeRange(oDArray, 10, 20);
+  DynArray_removeRange(oDArray, 25, 10);
+  assert(DynArray_getLength(oDArray) == 25);
+  for(l = 0; l < 10; l++)
+    assert(DynArray_get(oDArray, l) == apvInts[l + 5]);
+  for(l = 10; l < 25; l++)
+    assert(DynArray_get(oDArray, l) == apvInts[l + 25]);
+  assert(DynArray_addAt(oDArray, 25, apvInts[0]));
+  assert(DynArray_removeAt(oDArray, 0) == apvInts[5]);
+  assert(DynArray_get(oDArray, 24) == apvInts[0]);
+  DynArray_removeRange(oDArray, 0, 25);
+  assert(DynArray_getLength(oDArray) == 0);
+  DynArray_free(oDArray);
+  oIArray = IntArray_new(0);
+  assert(oIArray != NULL);
+  assert(IntArray_addRangeAt(oIArray, 0, aiInts, 0));
+  assert(IntArray_addRangeAt(oIArray, 0, aiInts + 20, 20));
+  assert(IntArray_addRangeAt(oIArray, 0, aiInts, 10));
+  assert(IntArray_addRangeAt(oIArray, 10, aiInts + 10, 10));
+  assert(IntArray_addRangeAt(oIArray, 40, aiInts + 40, 20));
+  assert(IntArray_addRangeAt(oIArray, 30, aiInts, 0));
+  assert(IntArray_getLength(oIArray) == 60);
+  for(l = 0; l < 60; l++)
+    assert(IntArray_get(oIArray, l) == (int) l);
+  IntArray_removeRange(oIArray, 0, 5);
+  IntArray_removeRange(oIArray, 10, 0);
+  IntArray_removeRange(oIArray, 10, 20);
+  IntArray_removeRange(oIArray, 25, 10);
+  assert(IntArray_getLength(oIArray) == 25);
+  for(l = 0; l < 10; l++)
+    assert(IntArray_get(oIArray, l) == (int) l + 5);
+  for(l = 10; l < 25; l++)
+    assert(IntArray_get(oIArray, l) == (int) l + 25);
+  IntArray_removeRange(oIArray, 0, 25);
+  assert(IntArray_getLength(oIArray) == 0);
+  IntArray_free(oIArray);
+
+  /* Sorts order ascending, descending, equal, and organ-pipe inputs,
+     both shorter and longer than the insertion sort cutoff, whether
+     the array is untyped or typed.
+  */
+  for(l = 0; l < sizeof(aulSortLengths) / sizeof(aulSortLengths[0]);
+      l++) {
+    ulLength = aulSortLengths[l];
+    for(iShape = 0; iShape < 4; iShape++) {
+      oDArray = DynArray_new(0);
+      assert(oDArray != NULL);
+      for(ulIndex = 0; ulIndex < ulLength; ulIndex++) {
+        aiSort[ulIndex] = shapedInt(iShape, ulIndex, ulLength);
+        assert(DynArray_add(oDArray, &aiSort[ulIndex]));
+      }
+      DynArray_sort(oDArray, compareIntPointers);
+      for(ulIndex = 0; ulIndex < ulLength; ulIndex++)
+        assert(*(int *) DynArray_get(oDArray, ulIndex) ==
+               sortedShapedInt(iShape, ulIndex));
+      DynArray_free(oDArray);
+      IntArray_sortRange(aiSort, ulLength);
+      for(ulIndex = 0; ulIndex < ulLength; ulIndex++)
+        assert(aiSort[ulIndex] == sortedShapedInt(iShape, ulIndex));
+    }
+  }
+
+  /* Against an adversary that drives quicksort quadratic, the
+     fallback to heapsort keeps the number of comparisons within a
+     small multiple of n log n, far below the n*n/4 quicksort alone
+     would take.
+  */
+  for(ulLog = 0, l = GAS_LENGTH; l > 1; l /= 2)
+    ulLog++;
+  oDArray = DynArray_new(0);
+  assert(oDArray != NULL);
+  startGas(GAS_LENGTH);
+  for(l = 0; l < GAS_LENGTH; l++) {
+    aiGasIndices[l] = (int) l;
+    assert(DynArray_add(oDArray, &aiGasIndices[l]));
+  }
+  DynArray_sort(oDArray, compareGasPointers);
+  assert(ulNumGasCompares < 8 * GAS_LENGTH * ulLog);
+  for(l = 1; l < GAS_LENGTH; l++)
+    assert(aiGasValues[*(int *) DynArray_get(oDArray, l - 1)] <=
+           aiGasValues[*(int *) DynArray_get(oDArray, l)]);
+  DynArray_free(oDArray);
+  startGas(GAS_LENGTH);
+  for(l = 0; l < GAS_LENGTH; l++)
+    aiGasIndices[l] = (int) l;
+  GasArray_sortRange(aiGasIndices, GAS_LENGTH);
+  assert(ulNumGasCompares < 8 * GAS_LENGTH * ulLog);
+  for(l = 1; l < GAS_LENGTH; l++)
+    assert(aiGasValues[aiGasIndices[l - 1]] <=
+           aiGasValues[aiGasIndices[l]]);
+
+  /* The key sort agrees with the comparison sort, equal keys and all,
+     on keys that share a 64-character prefix, keys that are prefixes
+     of other keys, and the empty key.
+  */
+  for(l = 0; l < 400; l++) {
+    memset(acKeys[l], 'x', 64);
+    if(l % 4 == 0) {
+      for(ulIndex = 64; ulIndex < 99; ulIndex++)
+        acKeys[l][ulIndex] = (char) ('a' + ulIndex % 3);
+      acKeys[l][(l * 37) % 99] = '\0';
+    }
+    else {
+      acKeys[l][64] = (char) ('a' + l % 3);
+      acKeys[l][65] = (char) ('a' + l / 3 % 3);
+      acKeys[l][66] = (char) ('a' + l / 9 % 3);
+      acKeys[l][64 + l % 4] = '\0';
+    }
+    asKeyed[l].pcKey = acKeys[l];
+    asKeyed[l].ulIndex = l;
+  }
+  memcpy(asExpected, asKeyed, sizeof(asKeyed));
+  KeyedArray_sortRange(asExpected, 400);
+  KeyedArray_sortRangeByKey(asKeyed, 400);
+  for(l = 0; l < 400; l++) {
+    assert(asKeyed[l].pcKey == asExpected[l].pcKey);
+    assert(asKeyed[l].ulIndex == asExpected[l].ulIndex);
+    if(l > 0)
+      assert(compareKeyed(asKeyed[l - 1], asKeyed[l]) < 0);
+  }
+
+  /* Removing a subtree drops its nodes from every name list, however
+     many of them share a name.
+  */
+  assert(FT_init() == SUCCESS);
+  assert(FT_enableNameIndex(TRUE) == SUCCESS);
+  assert(FT_insertDir("1root") == SUCCESS);
+  assert(FT_insertFile("1root/2a/3src", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2a/3b/3src", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2a/3c/3src", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2a-/3src", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("1root/2b/3src", NULL, 0) == SUCCESS);
+  assert(FT_rmDir("1root/2a") == SUCCESS);
+  arr[0] = '\0';
+  assert(FT_findByName("3src", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "1root/2a-/3src(f) 1root/2b/3src(f) "));
+  assert(FT_insertFile("1root/2a/3src", NULL, 0) == SUCCESS);
+  arr[0] = '\0';
+  assert(FT_findByName("3src", appendName, arr) == SUCCESS);
+  assert(!strcmp(arr, "1root/2a/3src(f) 1root/2a-/3src(f) "
+                 "1root/2b/3src(f) "));
+  assert(FT_destroy() == SUCCESS);
+
+  /* A directory that shrinks, and a trim pass, give memory back
+     without losing any remaining child, and the directory can grow
+     again afterwards.
+  */
+  assert(FT_trimMemory() == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_enableNameIndex(TRUE) == SUCCESS);
+  assert(FT_insertDir("1root/2big") == SUCCESS);
+  for(l = 0; l < 200; l++) {
+    sprintf(arr, "1root/2big/3f%03lu", (unsigned long) l);
+    assert(FT_insertFile(arr, NULL, l) == SUCCESS);
+  }
+  for(l = 0; l < 200; l++)
+    if(l % 50 != 7) {
+      sprintf(arr, "1root/2big/3f%03lu", (unsigned long) l);
+      assert(FT_rmFile(arr) == SUCCESS);
+    }
+  assert(FT_trimMemory() == SUCCESS);
+  for(l = 0; l < 200; l++) {
+    sprintf(arr, "1root/2big/3f%03lu", (unsigned long) l);
+    assert(FT_containsFile(arr) == (l % 50 == 7));
+  }
+  assert(FT_rmFile("1root/2big/3f007") == SUCCESS);
+  assert(FT_trimMemory() == SUCCESS);
+  assert(FT_insertFile("1root/2big/3f000", NULL, 0) == SUCCESS);
+  assert(FT_containsFile("1root/2big/3f000"));
+  assert(FT_containsFile("1root/2big/3f157"));
+  assert(FT_destroy() == SUCCESS);
+
+  /* A batch too long to sort by insertion alone still comes out in
+     tree order, in which "1root/2d" precedes "1root/2d/3f00" but
+     follows "1root/2d-01", and keeps repeated paths in the caller's
+     order.
+  */
+  for(l = 0; l < 38; l++) {
+    if(l % 2 == 0)
+      sprintf(acMany[l], "1root/2d/3f%02lu", (unsigned long) (37 - l));
+    else
+      sprintf(acMany[l], "1root/2d-%02lu", (unsigned long) (37 - l));
+    apcMany[l] = acMany[l];
+  }
+  apcMany[38] = "1root/2d";
+  apcMany[39] = acMany[1];
+  for(l = 0; l < 40; l++) {
+    apvMany[l] = NULL;
+    aulMany[l] = l;
+  }
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("1root") == SUCCESS);
+  assert(FT_insertBatch(apcMany, apvMany, aulMany, 40, aiMany) ==
+         SUCCESS);
+  for(l = 0; l < 38; l++)
+    assert(aiMany[l] == (l % 2 == 0 ? NOT_A_DIRECTORY : SUCCESS));
+  assert(aiMany[38] == SUCCESS);
+  assert(aiMany[39] == ALREADY_IN_TREE);
+  assert(FT_stat("1root/2d-36", &bIsFile, &l) == SUCCESS);
+  assert(l == 1);
+  assert(FT_containsFile("1root/2d") == TRUE);
+  assert(FT_destroy() == SUCCESS);
+
+  return 0;
+}
@@ -6,28 +6,224 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
-#include "dynarray.h"
+#include <limits.h>
+#include "arena.h"
+#include "atom.h"
 #include "nodeFT.h"
 #include "checkerFT.h"
 
-/* A node in a File Tree */
+/* The minimum physical length of a non-empty children array */
+enum { MIN_CHILDREN_LENGTH = 2 };
+
+/*
+  Once a key search has narrowed to this many children (one cache line
+  of keys), the remaining keys are counted with a straight-line loop
+  that the compiler can vectorize instead of bisected further.
+*/
+enum { KEY_SCAN_LENGTH = 8 };
+
+/* Hints that the memory at pv will be read soon, on compilers that
+   can pass the hint on to the processor. */
+#if defined(__GNUC__)
+#define NODE_PREFETCH(pv) __builtin_prefetch(pv)
+#else
+#define NODE_PREFETCH(pv) ((void) (pv))
+#endif
+
+/*
+  An entry in a directory's children array. The child's final path
+  component is kept inline so that searching the array only touches
+  the array itself and the name bytes, not the child node or its path.
+*/
+struct childEntry {
+    /* Final component of the child's path, an atom held by that
+       path */
+    const char *pcName;
+    /* Pointer to the child node */
+    Node_T oNChild;
+};
+
+/*
+  The fields shared by every node in a File Tree. These are the only
+  fields read while traversing, so they are kept together at the
+  start of both node kinds.
+*/
 struct node {
     /* Pointer to the path of the node */
     Path_T oPPath;
     /* Pointer to the parent of the node */
     Node_T oNParent;
-    /* Pointer to the dynarray of the children of the node */
-    DynArray_T oDChildren;
-    /* Boolean flag TRUE if node is a flag and FALSE otherwise */
+    /* Boolean flag TRUE if node is a file and FALSE otherwise */
     boolean isFile;
-    /* Pointer to the content of the node if it is a file, NULL
-    if it is a directory */
+    /* TRUE if the node was moved into an arena by Node_relocate, and
+       so must not be freed on its own */
+    boolean bInArena;
+};
+
+/* A directory node in a File Tree */
+struct dirNode {
+    /* The shared node fields, which must come first */
+    struct node sNode;
+    /* Number of children in psChildren */
+    size_t ulNumChildren;
+    /* Number of entries allocated for psChildren and pulKeys */
+    size_t ulPhysChildren;
+    /* Children sorted by name, or NULL if none were ever added */
+    struct childEntry *psChildren;
+    /* Packed name prefix keys, parallel to psChildren (see
+       Node_nameKey), so a search can bisect over a dense array of
+       integers and only read names when two prefixes tie */
+    unsigned long *pulKeys;
+    /* If the directory has exactly one child, the end of the chain of
+       only children below it (see Node_getChainEnd), which lets a
+       descent cross the whole chain at once; unused otherwise */
+    Node_T oNChainEnd;
+    /* TRUE if psChildren and pulKeys were moved into an arena by
+       Node_relocate, and so must be copied out before they can grow
+       and must not be freed */
+    boolean bChildrenInArena;
+};
+
+/* A file node in a File Tree, which never has children */
+struct fileNode {
+    /* The shared node fields, which must come first */
+    struct node sNode;
+    /* Pointer to the content of the file */
     void *pvContent;
-    /* Size of the content of the node if it is a file, uninitialized
-    otherwise */
+    /* Size of the content of the file */
     size_t ulSize;
 };
 
+/* Returns directory node oNNode as a struct dirNode. */
+static struct dirNode *Node_asDir(Node_T oNNode) {
+    assert(oNNode != NULL);
+    assert(!oNNode->isFile);
+
+    return (struct dirNode *) oNNode;
+}
+
+/* Returns file node oNNode as a struct fileNode. */
+static struct fileNode *Node_asFile(Node_T oNNode) {
+    assert(oNNode != NULL);
+    assert(oNNode->isFile);
+
+    return (struct fileNode *) oNNode;
+}
+
+/*
+  Returns the prefix key of the ulLength bytes at pcName: its first
+  sizeof(unsigned long) bytes packed big-endian and padded with '\0'.
+  Comparing two keys as integers orders them the same way strcmp
+  orders their names, except that names sharing a full key prefix
+  compare equal.
+*/
+static unsigned long Node_nameKey(const char *pcName, size_t ulLength) {
+    unsigned long ulKey = 0;
+    size_t i;
+
+    assert(pcName != NULL);
+
+    for(i = 0; i < sizeof(unsigned long); i++) {
+        ulKey <<= CHAR_BIT;
+        if(i < ulLength)
+            ulKey |= (unsigned char) pcName[i];
+    }
+    return ulKey;
+}
+
+/*
+  Compares the name in child entry psEntry with the ulLength bytes
+  at pcName, which need not be '\0'-terminated.
+  Returns <0, 0, or >0 if psEntry's name is "less than", "equal to",
+  or "greater than" pcName, respectively.
+*/
+static int Node_compareEntry(const struct childEntry *psEntry,
+                             const char *pcName, size_t ulLength) {
+    int iCompare;
+
+    assert(psEntry != NULL);
+    assert(pcName != NULL);
+
+    /* the names of paths are atoms, so a search for a path's own
+       component finds its entry without reading the name */
+    if(psEntry->pcName == pcName)
+        iCompare = 0;
+    else
+        iCompare = strncmp(psEntry->pcName, pcName, ulLength);
+    if(iCompare != 0)
+        return iCompare;
+    /* pcName is a prefix of the entry's name */
+    return psEntry->pcName[ulLength] != '\0';
+}
+
+/*
+  Brings the chain ends of directory oNDir and of the directories
+  above it in the same chain of only children up to date after
+  oNDir's number of children has changed. Only that run of ancestors
+  can have a chain end at or below oNDir.
+*/
+static void Node_updateChains(Node_T oNDir) {
+    struct dirNode *psDir;
+    Node_T oNEnd;
+    Node_T oNCurr;
+
+    assert(oNDir != NULL);
+
+    psDir = Node_asDir(oNDir);
+    if(psDir->ulNumChildren == 1) {
+        psDir->oNChainEnd =
+            Node_getChainEnd(psDir->psChildren[0].oNChild);
+        oNEnd = psDir->oNChainEnd;
+    }
+    else
+        oNEnd = oNDir;
+
+    for(oNCurr = oNDir->oNParent;
+        oNCurr != NULL && Node_asDir(oNCurr)->ulNumChildren == 1;
+        oNCurr = oNCurr->oNParent)
+        Node_asDir(oNCurr)->oNChainEnd = oNEnd;
+}
+
+/*
+  Reduces the children arrays of directory psDir to ulNewLength
+  entries, which must be at least its number of children, freeing
+  them if ulNewLength is 0. Arrays in an arena are left alone, as are
+  arrays that realloc cannot shrink, since the larger ones still work.
+*/
+static void Node_shrinkChildren(struct dirNode *psDir,
+                                size_t ulNewLength) {
+    struct childEntry *psNewChildren;
+    unsigned long *pulNewKeys;
+
+    assert(psDir != NULL);
+    assert(ulNewLength >= psDir->ulNumChildren);
+
+    if(psDir->bChildrenInArena || ulNewLength >= psDir->ulPhysChildren)
+        return;
+
+    if(ulNewLength == 0) {
+        free(psDir->psChildren);
+        free(psDir->pulKeys);
+        psDir->psChildren = NULL;
+        psDir->pulKeys = NULL;
+        psDir->ulPhysChildren = 0;
+        return;
+    }
+
+    /* as in Node_addChild, a keys array larger than ulPhysChildren is
+       harmless, so ulPhysChildren only needs the keys to shrink */
+    pulNewKeys = realloc(psDir->pulKeys,
+                         ulNewLength * sizeof(unsigned long));
+    if(pulNewKeys == NULL)
+        return;
+    psDir->pulKeys = pulNewKeys;
+    psNewChildren = realloc(psDir->psChildren,
+                            ulNewLength * sizeof(struct childEntry));
+    if(psNewChildren != NULL)
+        psDir->psChildren = psNewChildren;
+    psDir->ulPhysChildren = ulNewLength;
+}
+
 /*
   Links new child oNChild into oNParent's children array at index
   ulIndex. Returns SUCCESS if the new child was added successfully,
@@ -35,140 +231,201 @@ struct node {
 */
 static int Node_addChild(Node_T oNParent, Node_T oNChild,
                          size_t ulIndex) {
+    struct dirNode *psParent;
+    const char *pcName;
+    size_t ulDepth;
+
     assert(oNParent != NULL);
     assert(oNChild != NULL);
-    assert(!(oNParent->isFile));
-    
-    if(DynArray_addAt(oNParent->oDChildren, ulIndex, oNChild))
-        return SUCCESS;
-    else
-        return MEMORY_ERROR;
-}
 
-/*
-  Compares the string representation of oNfirst with a string
-  pcSecond representing a node's path.
-  Returns <0, 0, or >0 if oNFirst is "less than", "equal to", or
-  "greater than" pcSecond, respectively.
-*/
-static int Node_compareString(const Node_T oNFirst,
-                                 const char *pcSecond) {
-    assert(oNFirst != NULL);
-    assert(pcSecond != NULL);
+    psParent = Node_asDir(oNParent);
+    assert(ulIndex <= psParent->ulNumChildren);
+
+    if(psParent->ulNumChildren == psParent->ulPhysChildren) {
+        struct childEntry *psNewChildren;
+        unsigned long *pulNewKeys;
+        size_t ulNewLength = 2 * psParent->ulPhysChildren;
+
+        /* arrays in an arena cannot be reallocated, so they are first
+           copied to ordinary ones of the same size */
+        if(psParent->bChildrenInArena) {
+            pulNewKeys = malloc(psParent->ulNumChildren
+                                * sizeof(unsigned long));
+            psNewChildren = malloc(psParent->ulNumChildren
+                                   * sizeof(struct childEntry));
+            if(pulNewKeys == NULL || psNewChildren == NULL) {
+                free(pulNewKeys);
+                free(psNewChildren);
+                return MEMORY_ERROR;
+            }
+            memcpy(pulNewKeys, psParent->pulKeys,
+                   psParent->ulNumChildren * sizeof(unsigned long));
+            memcpy(psNewChildren, psParent->psChildren,
+                   psParent->ulNumChildren * sizeof(struct childEntry));
+            psParent->pulKeys = pulNewKeys;
+            psParent->psChildren = psNewChildren;
+            psParent->bChildrenInArena = FALSE;
+        }
 
-    return Path_compareString(oNFirst->oPPath, pcSecond);
+        if(ulNewLength < MIN_CHILDREN_LENGTH)
+            ulNewLength = MIN_CHILDREN_LENGTH;
+        /* a larger keys array is harmless if the second realloc
+           fails, so ulPhysChildren is only updated after both */
+        pulNewKeys = realloc(psParent->pulKeys,
+                             ulNewLength * sizeof(unsigned long));
+        if(pulNewKeys == NULL)
+            return MEMORY_ERROR;
+        psParent->pulKeys = pulNewKeys;
+        psNewChildren = realloc(psParent->psChildren,
+                                ulNewLength * sizeof(struct childEntry));
+        if(psNewChildren == NULL)
+            return MEMORY_ERROR;
+        psParent->psChildren = psNewChildren;
+        psParent->ulPhysChildren = ulNewLength;
+    }
+
+    memmove(&psParent->psChildren[ulIndex + 1],
+            &psParent->psChildren[ulIndex],
+            (psParent->ulNumChildren - ulIndex)
+            * sizeof(struct childEntry));
+    memmove(&psParent->pulKeys[ulIndex + 1],
+            &psParent->pulKeys[ulIndex],
+            (psParent->ulNumChildren - ulIndex)
+            * sizeof(unsigned long));
+
+    ulDepth = Path_getDepth(oNChild->oPPath);
+    pcName = Path_getComponent(oNChild->oPPath, ulDepth - 1);
+    psParent->psChildren[ulIndex].pcName = pcName;
+    psParent->psChildren[ulIndex].oNChild = oNChild;
+    psParent->pulKeys[ulIndex] =
+        Node_nameKey(pcName, Atom_getLength(pcName));
+    psParent->ulNumChildren++;
+    Node_updateChains(oNParent);
+
+    return SUCCESS;
 }
 
 /*
-    Compares the string representation of the path of oNfirst
-    with a string representation of the path of oNSecond.
-    Returns <0, 0, or >0 if oNFirst's path is "less than", 
-    "equal to", or "greater than" the path of oNSecond, 
-    respectively.
+  Unlinks the child at index ulIndex from oNParent's children array.
 */
-static int Node_compare(Node_T oNFirst, Node_T oNSecond) {
-   assert(oNFirst != NULL);
-   assert(oNSecond != NULL);
+static void Node_removeChild(Node_T oNParent, size_t ulIndex) {
+    struct dirNode *psParent;
 
-   return Path_comparePath(oNFirst->oPPath, oNSecond->oPPath);
+    assert(oNParent != NULL);
+
+    psParent = Node_asDir(oNParent);
+    assert(ulIndex < psParent->ulNumChildren);
+
+    psParent->ulNumChildren--;
+    memmove(&psParent->psChildren[ulIndex],
+            &psParent->psChildren[ulIndex + 1],
+            (psParent->ulNumChildren - ulIndex)
+            * sizeof(struct childEntry));
+    memmove(&psParent->pulKeys[ulIndex],
+            &psParent->pulKeys[ulIndex + 1],
+            (psParent->ulNumChildren - ulIndex)
+            * sizeof(unsigned long));
+
+    /* halve the arrays once they are no more than a quarter full; the
+       gap to the half at which they are left keeps a directory whose
+       size goes back and forth from reallocating every time */
+    if(psParent->ulNumChildren <= psParent->ulPhysChildren / 4 &&
+       psParent->ulPhysChildren / 2 >= MIN_CHILDREN_LENGTH)
+        Node_shrinkChildren(psParent, psParent->ulPhysChildren / 2);
+    Node_updateChains(oNParent);
 }
 
-int Node_newDir(Path_T oPPath, Node_T oNParent, Node_T *poNResult)
-{
-    struct node *psNew;
-    Path_T oPParentPath = NULL;
+/*
+  Creates a new node in the File Tree with path oPPath and parent
+  oNParent: a file with content pvContent of size ulSize if isFile
+  is TRUE, or a directory otherwise. Links the node into oNParent's
+  children if bLink is TRUE, and otherwise leaves that (and checking
+  for an existing child with the same path) to Node_setChildren.
+  Returns statuses exactly as described for Node_newDir and
+  Node_newFile.
+*/
+static int Node_new(Path_T oPPath, Node_T oNParent, boolean isFile,
+                    void *pvContent, size_t ulSize, boolean bLink,
+                    Node_T *poNResult) {
+    Node_T oNNew;
     Path_T oPNewPath = NULL;
-    size_t ulParentDepth;
     size_t ulIndex = 0;
     int iStatus;
-    
 
     assert(oPPath != NULL);
+    assert(poNResult != NULL);
     assert(oNParent == NULL || CheckerFT_Node_isValid(oNParent));
 
-    psNew = malloc(sizeof(struct node));
-    /* memory allocation failed */
-    if (psNew == NULL) {
-        *poNResult = NULL;
-        return MEMORY_ERROR;
-    }
-
-    psNew->isFile = FALSE;
-    psNew->pvContent = NULL;
-
-    iStatus = Path_dup(oPPath, &oPNewPath);
-    /* path duplication failed */
-    if (iStatus != SUCCESS) {
-        free(psNew);
-        *poNResult = NULL;
-        return iStatus;
-    }
-    psNew->oPPath = oPNewPath;
+    *poNResult = NULL;
 
-    /* check if prefix of oPPath is the same as the path of oNParent*/
+    /* check if the oNParent is a prefix of oPPath */
     if (oNParent != NULL) {
-        size_t ulSharedDepth;
-
-        oPParentPath = oNParent->oPPath;
-        ulParentDepth = Path_getDepth(oPParentPath);
-        ulSharedDepth = Path_getSharedPrefixDepth(psNew->oPPath,
-                                                oPParentPath);
-        if (ulSharedDepth < ulParentDepth) {
-            Path_free(psNew->oPPath);
-            free(psNew);
-            *poNResult = NULL;
+        size_t ulParentDepth = Path_getDepth(oNParent->oPPath);
+
+        if (Path_getSharedPrefixDepth(oPPath, oNParent->oPPath)
+            < ulParentDepth)
             return CONFLICTING_PATH;
-        }
 
         /* parent must be exactly one level up from child */
-        if(Path_getDepth(psNew->oPPath) != ulParentDepth + 1) {
-            Path_free(psNew->oPPath);
-            free(psNew);
-            *poNResult = NULL;
+        if(Path_getDepth(oPPath) != ulParentDepth + 1)
             return NO_SUCH_PATH;
-        }
 
-        /* node is already in tree */
-        if(Node_hasChild(oNParent, oPPath, &ulIndex)) {
-            Path_free(psNew->oPPath);
-            free(psNew);
-            *poNResult = NULL;
+        /* node already exists in tree */
+        if(bLink && Node_hasChild(oNParent, oPPath, &ulIndex))
             return ALREADY_IN_TREE;
-        }
     }
     else {
         /* new node must be root */
         /* can only create one "level" at a time */
-        if(Path_getDepth(psNew->oPPath) != 1) {
-            Path_free(psNew->oPPath);
-            free(psNew);
-            *poNResult = NULL;
+        if(Path_getDepth(oPPath) != 1)
             return NO_SUCH_PATH;
-        }
     }
-    psNew->oNParent = oNParent;
 
-    psNew->oDChildren = DynArray_new(0);
-    /* memory allocation failed */
-    if(psNew->oDChildren == NULL) {
-        Path_free(psNew->oPPath);
-        free(psNew);
-        *poNResult = NULL;
-        return MEMORY_ERROR;
+    if(isFile) {
+        struct fileNode *psFile = malloc(sizeof(struct fileNode));
+        /* memory allocation error */
+        if(psFile == NULL)
+            return MEMORY_ERROR;
+        psFile->pvContent = pvContent;
+        psFile->ulSize = ulSize;
+        oNNew = &psFile->sNode;
+    }
+    else {
+        struct dirNode *psDir = malloc(sizeof(struct dirNode));
+        /* memory allocation error */
+        if(psDir == NULL)
+            return MEMORY_ERROR;
+        /* the children array is allocated on first insertion */
+        psDir->ulNumChildren = 0;
+        psDir->ulPhysChildren = 0;
+        psDir->psChildren = NULL;
+        psDir->pulKeys = NULL;
+        psDir->oNChainEnd = NULL;
+        psDir->bChildrenInArena = FALSE;
+        oNNew = &psDir->sNode;
+    }
+    oNNew->isFile = isFile;
+    oNNew->bInArena = FALSE;
+    oNNew->oNParent = oNParent;
+
+    iStatus = Path_dup(oPPath, &oPNewPath);
+    /* path duplication failed */
+    if (iStatus != SUCCESS) {
+        free(oNNew);
+        return iStatus;
     }
+    oNNew->oPPath = oPNewPath;
 
     /* Link into parent's children list */
-    if(oNParent != NULL) {
-        iStatus = Node_addChild(oNParent, psNew, ulIndex);
+    if(bLink && oNParent != NULL) {
+        iStatus = Node_addChild(oNParent, oNNew, ulIndex);
         if(iStatus != SUCCESS) {
-            Path_free(psNew->oPPath);
-            DynArray_free(psNew->oDChildren);
-            free(psNew);
-            *poNResult = NULL;
+            Path_free(oNNew->oPPath);
+            free(oNNew);
             return iStatus;
         }
     }
-    *poNResult = psNew;
+    *poNResult = oNNew;
 
     assert(oNParent == NULL || CheckerFT_Node_isValid(oNParent));
     assert(CheckerFT_Node_isValid(*poNResult));
@@ -176,141 +433,203 @@ int Node_newDir(Path_T oPPath, Node_T oNParent, Node_T *poNResult)
     return SUCCESS;
 }
 
-int Node_newFile(Path_T oPPath, Node_T oNParent, Node_T *poNResult, 
-                void *pvContent, size_t ulSize) {
-    struct node *psNew;
-    Path_T oPParentPath = NULL;
-    Path_T oPNewPath = NULL;
-    size_t ulParentDepth;
-    size_t ulIndex = 0;
-    int iStatus;
-    
+int Node_newDir(Path_T oPPath, Node_T oNParent, Node_T *poNResult)
+{
+    return Node_new(oPPath, oNParent, FALSE, NULL, 0, TRUE, poNResult);
+}
 
-    assert(oPPath != NULL);
-    assert(oNParent == NULL || CheckerFT_Node_isValid(oNParent));
+int Node_newFile(Path_T oPPath, Node_T oNParent, Node_T *poNResult,
+                void *pvContent, size_t ulSize) {
+    return Node_new(oPPath, oNParent, TRUE, pvContent, ulSize, TRUE,
+                    poNResult);
+}
 
-    psNew = malloc(sizeof(struct node));
-    /* memory allocation error */
-    if (psNew == NULL) {
-        *poNResult = NULL;
-        return MEMORY_ERROR;
-    }
+int Node_newUnlinked(Path_T oPPath, Node_T oNParent, boolean isFile,
+                     void *pvContent, size_t ulSize,
+                     Node_T *poNResult) {
+    return Node_new(oPPath, oNParent, isFile, pvContent, ulSize, FALSE,
+                    poNResult);
+}
 
-    psNew->isFile = TRUE;
-    psNew->pvContent = pvContent;
-    psNew->ulSize = ulSize;
+int Node_setChildren(Node_T oNParent, Node_T aoNChildren[],
+                     size_t ulNumChildren) {
+    struct dirNode *psParent;
+    size_t i;
 
-    iStatus = Path_dup(oPPath, &oPNewPath);
-    /* path duplication failed */
-    if (iStatus != SUCCESS) {
-        free(psNew);
-        *poNResult = NULL;
-        return iStatus;
-    }
-    psNew->oPPath = oPNewPath;
+    assert(oNParent != NULL);
+    assert(aoNChildren != NULL || ulNumChildren == 0);
 
-    /* check if the oNParent is a prefix of oPPath */
-    if (oNParent != NULL) {
-        size_t ulSharedDepth;
-
-        oPParentPath = oNParent->oPPath;
-        ulParentDepth = Path_getDepth(oPParentPath);
-        ulSharedDepth = Path_getSharedPrefixDepth(psNew->oPPath,
-                                                oPParentPath);
-        if (ulSharedDepth < ulParentDepth) {
-            Path_free(psNew->oPPath);
-            free(psNew);
-            *poNResult = NULL;
-            return CONFLICTING_PATH;
-        }
+    psParent = Node_asDir(oNParent);
+    assert(psParent->ulNumChildren == 0);
 
-        /* parent must be exactly one level up from child */
-        if(Path_getDepth(psNew->oPPath) != ulParentDepth + 1) {
-            Path_free(psNew->oPPath);
-            free(psNew);
-            *poNResult = NULL;
-            return NO_SUCH_PATH;
-        }
+    if(ulNumChildren == 0)
+        return SUCCESS;
 
-        /* node already exists in tree */
-        if(Node_hasChild(oNParent, oPPath, &ulIndex)) {
-            Path_free(psNew->oPPath);
-            free(psNew);
-            *poNResult = NULL;
-            return ALREADY_IN_TREE;
-        }
+    /* the arrays are sized exactly, since a directory built in bulk
+       is not expected to grow much */
+    psParent->pulKeys = malloc(ulNumChildren * sizeof(unsigned long));
+    psParent->psChildren =
+        malloc(ulNumChildren * sizeof(struct childEntry));
+    if(psParent->pulKeys == NULL || psParent->psChildren == NULL) {
+        free(psParent->pulKeys);
+        free(psParent->psChildren);
+        psParent->pulKeys = NULL;
+        psParent->psChildren = NULL;
+        return MEMORY_ERROR;
     }
-    else {
-        /* new node must be root */
-        /* can only create one "level" at a time */
-        if(Path_getDepth(psNew->oPPath) != 1) {
-            Path_free(psNew->oPPath);
-            free(psNew);
-            *poNResult = NULL;
-            return NO_SUCH_PATH;
-        }
+    psParent->ulPhysChildren = ulNumChildren;
+
+    for(i = 0; i < ulNumChildren; i++) {
+        const char *pcName = Node_getName(aoNChildren[i]);
+
+        assert(aoNChildren[i]->oNParent == oNParent);
+        assert(i == 0 || strcmp(psParent->psChildren[i - 1].pcName,
+                                pcName) < 0);
+        psParent->psChildren[i].pcName = pcName;
+        psParent->psChildren[i].oNChild = aoNChildren[i];
+        psParent->pulKeys[i] = Node_nameKey(pcName,
+                                            Atom_getLength(pcName));
     }
-    psNew->oNParent = oNParent;
+    psParent->ulNumChildren = ulNumChildren;
+    Node_updateChains(oNParent);
 
-    psNew->oDChildren = DynArray_new(0);
-    /* memory allocation failed */
-    if(psNew->oDChildren == NULL) {
-        Path_free(psNew->oPPath);
-        free(psNew);
-        *poNResult = NULL;
-        return MEMORY_ERROR;
-    }
+    return SUCCESS;
+}
 
-    /* Link into parent's children list */
-    if(oNParent != NULL) {
-        iStatus = Node_addChild(oNParent, psNew, ulIndex);
-        if(iStatus != SUCCESS) {
-            Path_free(psNew->oPPath);
-            free(psNew);
-            *poNResult = NULL;
-            return iStatus;
+/*
+  Frees the subtree rooted at oNNode without unlinking oNNode from
+  its parent. Returns the number of nodes freed.
+*/
+static size_t Node_freeSubtree(Node_T oNNode) {
+    size_t ulCount = 0;
+
+    assert(oNNode != NULL);
+
+    if(!oNNode->isFile) {
+        struct dirNode *psDir = Node_asDir(oNNode);
+        size_t i;
+
+        /* children are freed in place, so no array shifting */
+        for(i = 0; i < psDir->ulNumChildren; i++)
+            ulCount += Node_freeSubtree(psDir->psChildren[i].oNChild);
+        if(!psDir->bChildrenInArena) {
+            free(psDir->psChildren);
+            free(psDir->pulKeys);
         }
     }
-    *poNResult = psNew;
 
-    assert(oNParent == NULL || CheckerFT_Node_isValid(oNParent));
-    assert(CheckerFT_Node_isValid(*poNResult));
+    /* remove path */
+    Path_free(oNNode->oPPath);
 
-    return SUCCESS;
-    }
+    /* finally, free the node itself, unless its arena owns it */
+    if(!oNNode->bInArena)
+        free(oNNode);
+    ulCount++;
+    return ulCount;
+}
 
 size_t Node_free(Node_T oNNode) {
     size_t ulIndex = 0;
-    size_t ulCount = 0;
 
     assert(oNNode != NULL);
     assert(CheckerFT_Node_isValid(oNNode));
 
     /* remove from parent's list */
     if(oNNode->oNParent != NULL) {
-        if(DynArray_bsearch(
-        oNNode->oNParent->oDChildren,
-        oNNode, &ulIndex,
-        (int (*)(const void *, const void *)) Node_compare)
-        )
-        (void) DynArray_removeAt(oNNode->oNParent->oDChildren,
-                                ulIndex);
+        if(Node_hasChild(oNNode->oNParent, oNNode->oPPath, &ulIndex))
+            Node_removeChild(oNNode->oNParent, ulIndex);
     }
 
-    /* recursively remove children */
-    while (DynArray_getLength(oNNode->oDChildren) != 0) {
-        ulCount += Node_free(DynArray_get(oNNode->oDChildren, 0));
+    return Node_freeSubtree(oNNode);
+}
+
+int Node_relocate(Node_T oNNode, Arena_T oArena, Node_T *poNResult) {
+    Node_T oNNew;
+    Node_T oNCurr;
+    struct dirNode *psOld = NULL;
+    struct dirNode *psNew = NULL;
+    void *pvPath;
+    size_t ulIndex = 0;
+    size_t i;
+
+    assert(oNNode != NULL);
+    assert(oArena != NULL);
+    assert(poNResult != NULL);
+
+    *poNResult = NULL;
+
+    if(oNNode->isFile) {
+        oNNew = Arena_alloc(oArena, sizeof(struct fileNode));
+        if(oNNew == NULL)
+            return MEMORY_ERROR;
+        memcpy(oNNew, oNNode, sizeof(struct fileNode));
+    }
+    else {
+        psOld = Node_asDir(oNNode);
+        psNew = Arena_alloc(oArena, sizeof(struct dirNode));
+        if(psNew == NULL)
+            return MEMORY_ERROR;
+        memcpy(psNew, psOld, sizeof(struct dirNode));
+        oNNew = &psNew->sNode;
     }
 
-    DynArray_free(oNNode->oDChildren);
+    /* the path and its pathname directly follow the node, so that
+       reading a node's pathname stays within the arena */
+    pvPath = Arena_alloc(oArena, Path_getRelocatedSize(oNNode->oPPath));
+    if(pvPath == NULL)
+        return MEMORY_ERROR;
 
-    /* remove path */
-    Path_free(oNNode->oPPath);
+    if(psNew != NULL) {
+        /* the children move with the node, at their exact size */
+        psNew->ulPhysChildren = psOld->ulNumChildren;
+        psNew->bChildrenInArena = psOld->ulNumChildren != 0;
+        if(psNew->bChildrenInArena) {
+            psNew->psChildren = Arena_alloc(oArena,
+                psOld->ulNumChildren * sizeof(struct childEntry));
+            psNew->pulKeys = Arena_alloc(oArena,
+                psOld->ulNumChildren * sizeof(unsigned long));
+            if(psNew->psChildren == NULL || psNew->pulKeys == NULL)
+                return MEMORY_ERROR;
+            memcpy(psNew->psChildren, psOld->psChildren,
+                   psOld->ulNumChildren * sizeof(struct childEntry));
+            memcpy(psNew->pulKeys, psOld->pulKeys,
+                   psOld->ulNumChildren * sizeof(unsigned long));
+        }
+        else {
+            psNew->psChildren = NULL;
+            psNew->pulKeys = NULL;
+        }
+    }
+    oNNew->bInArena = TRUE;
 
-    /* finally, free the struct node */
-    free(oNNode);
-    ulCount++;
-    return ulCount;
+    /* point the parent, the children, and any chain that ends here
+       at the new copy */
+    if(oNNode->oNParent != NULL) {
+        (void) Node_hasChild(oNNode->oNParent, oNNode->oPPath,
+                             &ulIndex);
+        Node_asDir(oNNode->oNParent)->psChildren[ulIndex].oNChild =
+            oNNew;
+    }
+    if(psNew != NULL)
+        for(i = 0; i < psNew->ulNumChildren; i++)
+            psNew->psChildren[i].oNChild->oNParent = oNNew;
+    for(oNCurr = oNNode->oNParent;
+        oNCurr != NULL && Node_asDir(oNCurr)->ulNumChildren == 1 &&
+        Node_asDir(oNCurr)->oNChainEnd == oNNode;
+        oNCurr = oNCurr->oNParent)
+        Node_asDir(oNCurr)->oNChainEnd = oNNew;
+
+    oNNew->oPPath = Path_relocate(oNNode->oPPath, pvPath);
+
+    if(psOld != NULL && !psOld->bChildrenInArena) {
+        free(psOld->psChildren);
+        free(psOld->pulKeys);
+    }
+    if(!oNNode->bInArena)
+        free(oNNode);
+
+    *poNResult = oNNew;
+    return SUCCESS;
 }
 
 Path_T Node_getPath(Node_T oNNode) {
@@ -319,22 +638,134 @@ Path_T Node_getPath(Node_T oNNode) {
     return oNNode->oPPath;
 }
 
+const char *Node_getName(Node_T oNNode) {
+    assert(oNNode != NULL);
+
+    return Path_getComponent(oNNode->oPPath,
+                             Path_getDepth(oNNode->oPPath) - 1);
+}
+
+boolean Node_hasChildName(Node_T oNParent, const char *pcName,
+                          size_t ulLength, size_t *pulChildID) {
+    struct dirNode *psParent;
+    const unsigned long *pulKeys;
+    unsigned long ulKey;
+    size_t ulLo, ulHi, ulLess, i;
+
+    assert(oNParent != NULL);
+    assert(pcName != NULL);
+    assert(pulChildID != NULL);
+
+    psParent = Node_asDir(oNParent);
+    pulKeys = psParent->pulKeys;
+    ulKey = Node_nameKey(pcName, ulLength);
+
+    /* bisect the keys for the first one not less than ulKey until
+       the answer lies within one short run of [ulLo, ulHi] */
+    ulLo = 0;
+    ulHi = psParent->ulNumChildren;
+    while(ulHi - ulLo > KEY_SCAN_LENGTH) {
+        size_t ulMid = ulLo + (ulHi - ulLo) / 2;
+        if(pulKeys[ulMid] < ulKey)
+            ulLo = ulMid + 1;
+        else
+            ulHi = ulMid;
+    }
+    /* count the keys less than ulKey in the remaining run */
+    ulLess = 0;
+    for(i = ulLo; i < ulHi; i++)
+        ulLess += (pulKeys[i] < ulKey);
+    ulLo += ulLess;
+
+    /* only children whose prefix ties with pcName's need their full
+       names compared */
+    for(i = ulLo; i < psParent->ulNumChildren && pulKeys[i] == ulKey;
+        i++) {
+        int iCompare;
+
+        /* a tie on a name shorter than the key covers the whole name,
+           including its terminating '\0' */
+        if(ulLength < sizeof(unsigned long)) {
+            *pulChildID = i;
+            return TRUE;
+        }
+        iCompare = Node_compareEntry(&psParent->psChildren[i],
+                                     pcName, ulLength);
+        if(iCompare == 0) {
+            *pulChildID = i;
+            return TRUE;
+        }
+        if(iCompare > 0)
+            break;
+    }
+
+    /* *pulChildID is the index into oNParent's children */
+    *pulChildID = i;
+    return FALSE;
+}
+
+void Node_prefetch(Node_T oNNode) {
+    assert(oNNode != NULL);
+
+    NODE_PREFETCH(oNNode);
+}
+
+void Node_prefetchChildren(Node_T oNNode) {
+    struct dirNode *psDir;
+
+    assert(oNNode != NULL);
+
+    if(oNNode->isFile)
+        return;
+    psDir = Node_asDir(oNNode);
+    if(psDir->ulNumChildren == 0)
+        return;
+
+    /* the first key a search reads is the middle one */
+    NODE_PREFETCH(&psDir->pulKeys[psDir->ulNumChildren / 2]);
+}
+
 boolean Node_hasChild(Node_T oNParent, Path_T oPPath,
                          size_t *pulChildID) {
+   const char *pcName;
+
    assert(oNParent != NULL);
    assert(oPPath != NULL);
    assert(pulChildID != NULL);
+   assert(Path_getDepth(oPPath) == Path_getDepth(oNParent->oPPath) + 1);
 
-   /* *pulChildID is the index into oNParent->oDChildren */
-   return DynArray_bsearch(oNParent->oDChildren,
-            (char*) Path_getPathname(oPPath), pulChildID,
-            (int (*)(const void*,const void*)) Node_compareString);
+   /* siblings share every component but the last, so comparing the
+      last components orders them the same as their full paths */
+   pcName = Path_getComponent(oPPath, Path_getDepth(oPPath) - 1);
+   return Node_hasChildName(oNParent, pcName, Atom_getLength(pcName),
+                            pulChildID);
+}
+
+Node_T Node_getChainEnd(Node_T oNNode) {
+    assert(oNNode != NULL);
+
+    if(Node_getNumChildren(oNNode) != 1)
+        return oNNode;
+    return Node_asDir(oNNode)->oNChainEnd;
+}
+
+void Node_trimChildren(Node_T oNNode) {
+    assert(oNNode != NULL);
+
+    if(oNNode->isFile)
+        return;
+    Node_shrinkChildren(Node_asDir(oNNode),
+                        Node_asDir(oNNode)->ulNumChildren);
 }
 
 size_t Node_getNumChildren(Node_T oNParent) {
    assert(oNParent != NULL);
 
-   return DynArray_getLength(oNParent->oDChildren);
+   /* files are always leaves */
+   if(oNParent->isFile)
+      return 0;
+
+   return Node_asDir(oNParent)->ulNumChildren;
 }
 
 int Node_getChild(Node_T oNParent, size_t ulChildID,
@@ -344,13 +775,13 @@ int Node_getChild(Node_T oNParent, size_t ulChildID,
     assert(poNResult != NULL);
     assert(!oNParent->isFile);
 
-    /* ulChildID is the index into oNParent->oDChildren */
+    /* ulChildID is the index into oNParent's children */
     if(ulChildID >= Node_getNumChildren(oNParent)) {
         *poNResult = NULL;
         return NO_SUCH_PATH;
     }
     else {
-        *poNResult = DynArray_get(oNParent->oDChildren, ulChildID);
+        *poNResult = Node_asDir(oNParent)->psChildren[ulChildID].oNChild;
         return SUCCESS;
    }
 }
@@ -363,27 +794,26 @@ Node_T Node_getParent(Node_T oNNode) {
 
 void *Node_getCont(Node_T oNNode) {
     assert(oNNode != NULL);
-    assert(oNNode->isFile);
 
-    return oNNode->pvContent;
+    return Node_asFile(oNNode)->pvContent;
 }
 
 size_t Node_getContSize(Node_T oNNode) {
     assert (oNNode != NULL);
-    assert (oNNode -> isFile);
 
-    return oNNode->ulSize;
+    return Node_asFile(oNNode)->ulSize;
 }
 
 void *Node_replaceCont(Node_T oNNode, void *pvContent, size_t ulSize) {
+    struct fileNode *psFile;
     void *pvOld;
 
     assert(oNNode != NULL);
-    assert(oNNode->isFile);
 
-    pvOld = oNNode->pvContent;
-    oNNode->pvContent = pvContent;
-    oNNode->ulSize = ulSize;
+    psFile = Node_asFile(oNNode);
+    pvOld = psFile->pvContent;
+    psFile->pvContent = pvContent;
+    psFile->ulSize = ulSize;
 
     return pvOld;
 }
@@ -404,4 +834,4 @@ char *Node_toString(Node_T oNNode) {
         return NULL;
     else
         return strcpy(copyPath, Path_getPathname(Node_getPath(oNNode)));
-}
\ No newline at end of file
+}
@@ -7,6 +7,7 @@
 #define NODE_INCLUDED
 
 #include "a4def.h"
+#include "arena.h"
 #include "path.h"
 #include <stddef.h>
 
@@ -43,6 +44,29 @@ int Node_newDir(Path_T oPPath, Node_T oNParent, Node_T *poNResult);
 int Node_newFile(Path_T oPPath, Node_T oNParent, Node_T *poNResult, 
 void *pvContent, size_t ulSize);
 
+/*
+  Creates a new node in the File Tree with path oPPath and parent
+  oNParent, as Node_newFile does (with content pvContent of size
+  ulSize) if isFile is TRUE and as Node_newDir does otherwise, but
+  without linking it into oNParent's children or checking them for a
+  node with the same path. Returns the same statuses as Node_newDir
+  and Node_newFile, except never ALREADY_IN_TREE.
+*/
+int Node_newUnlinked(Path_T oPPath, Node_T oNParent, boolean isFile,
+                     void *pvContent, size_t ulSize,
+                     Node_T *poNResult);
+
+/*
+  Links the ulNumChildren nodes in aoNChildren, each created by
+  Node_newUnlinked with parent oNParent, as the children of directory
+  oNParent, which must have none. The nodes must be sorted by final
+  path component, with no two alike. Allocates room for exactly
+  ulNumChildren children. Returns SUCCESS, or MEMORY_ERROR, leaving
+  oNParent unchanged, if memory could not be allocated.
+*/
+int Node_setChildren(Node_T oNParent, Node_T aoNChildren[],
+                     size_t ulNumChildren);
+
 /*
   Destroys and frees all memory allocated for the subtree rooted at
   oNNode, i.e., deletes this node and all its descendents. Returns the
@@ -50,9 +74,27 @@ void *pvContent, size_t ulSize);
 */
 size_t Node_free(Node_T oNNode);
 
+/*
+  Moves oNNode, its path and pathname (see Path_relocate), and its
+  children array if it is a directory, into oArena, so that nodes
+  relocated one after another lie together in memory. Updates oNNode's
+  parent and children to refer to the new copy. oNNode and its path
+  are no longer valid afterwards, and any other reference to either
+  must be replaced with the new copy's. Node_free releases everything
+  of a relocated node except the memory oArena owns, which is only
+  freed with oArena.
+  Returns SUCCESS and sets *poNResult to the new copy, or sets
+  *poNResult to NULL, leaves oNNode unchanged and returns:
+  * MEMORY_ERROR if memory could not be allocated from oArena
+*/
+int Node_relocate(Node_T oNNode, Arena_T oArena, Node_T *poNResult);
+
 /* Returns the path object representing oNNode's absolute path. */
 Path_T Node_getPath(Node_T oNNode);
 
+/* Returns the final component of oNNode's absolute path. */
+const char *Node_getName(Node_T oNNode);
+
 /*
   Returns TRUE if oNParent has a child with path oPPath. Returns
   FALSE if it does not.
@@ -64,7 +106,46 @@ Path_T Node_getPath(Node_T oNNode);
 */
 boolean Node_hasChild(Node_T oNParent, Path_T oPPath,
                          size_t *pulChildID);
+
+/*
+  Returns TRUE if oNParent has a child whose final path component is
+  the ulLength bytes at pcName (which need not be '\0'-terminated),
+  and FALSE if it does not. Stores in *pulChildID the child's
+  identifier, or the identifier such a child would have if inserted,
+  as in Node_hasChild. oNParent must be a directory.
+*/
+boolean Node_hasChildName(Node_T oNParent, const char *pcName,
+                          size_t ulLength, size_t *pulChildID);
                         
+/*
+  Hints that oNNode will be read soon, so that fetching it from memory
+  can overlap other work. Does not itself read oNNode.
+*/
+void Node_prefetch(Node_T oNNode);
+
+/*
+  Hints that oNNode's children will be searched soon, as
+  Node_prefetch does for oNNode itself. Reads oNNode.
+*/
+void Node_prefetchChildren(Node_T oNNode);
+
+/*
+  Returns the end of the chain of only children starting at oNNode:
+  the first node reached by repeatedly moving to the only child of a
+  directory with exactly one child, or oNNode itself if it is not such
+  a directory. Every node strictly between oNNode and the returned
+  node is a directory with exactly one child, so the returned node's
+  path spells out the whole chain. Takes constant time.
+*/
+Node_T Node_getChainEnd(Node_T oNNode);
+
+/*
+  Releases the memory oNNode's children arrays hold beyond what its
+  children need, all of it if it has none. Arrays that Node_relocate
+  moved into an arena are left as they are, since they are exact.
+*/
+void Node_trimChildren(Node_T oNNode);
+
 /* Returns the number of children that oNParent has. */
 size_t Node_getNumChildren(Node_T oNParent);
 
@@ -0,0 +1,355 @@
+/*--------------------------------------------------------------------*/
+/* symtable.c                                                         */
+/* Author: John Matters, Daniel Wang                                  */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The successive bucket counts of a SymTable. The table expands to
+   the next count whenever its number of bindings exceeds its bucket
+   count, and stays at the last count afterwards. */
+
+static const size_t auBucketCounts[] = {
+   509, 1021, 2039, 4093, 8191, 16381, 32749, 65521,
+   131071, 262139, 524287, 1048573, 2097143, 4194301, 8388593,
+   16777213, 33554393, 67108859
+};
+
+/* The number of entries in auBucketCounts. */
+
+static const size_t NUM_BUCKET_COUNTS =
+   sizeof(auBucketCounts) / sizeof(auBucketCounts[0]);
+
+/*--------------------------------------------------------------------*/
+
+/* Each key-value pair is stored in a Binding. Bindings in the same
+   bucket are linked to form a list. */
+
+struct Binding
+{
+   /* The hash of pcKey, kept so that lookups can skip strcmp on
+      mismatched hashes and expansion need not rehash the keys. */
+   size_t uHash;
+
+   /* The defensive copy of the key. */
+   const char *pcKey;
+
+   /* The value. */
+   const void *pvValue;
+
+   /* The address of the next Binding in the bucket. */
+   struct Binding *psNextBinding;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable is an array of buckets, each of which is a list of
+   Bindings, along with the number of bindings it holds. */
+
+struct SymTable
+{
+   /* The number of bindings in the SymTable. */
+   size_t uLength;
+
+   /* The index of the bucket count in auBucketCounts. */
+   size_t uBucketCountIndex;
+
+   /* The array of buckets. */
+   struct Binding **ppsBuckets;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a hash code for pcKey. */
+
+static size_t SymTable_hash(const char *pcKey)
+{
+   const size_t HASH_MULTIPLIER = 65599;
+   size_t u;
+   size_t uHash = 0;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; pcKey[u] != '\0'; u++)
+      uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of buckets of oSymTable. */
+
+static size_t SymTable_getBucketCount(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   return auBucketCounts[oSymTable->uBucketCountIndex];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the Binding of oSymTable whose key is pcKey and whose hash
+   is uHash, or NULL if there is none. */
+
+static struct Binding *SymTable_find(SymTable_T oSymTable,
+                                     const char *pcKey, size_t uHash)
+{
+   struct Binding *psBinding;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   for (psBinding = oSymTable->ppsBuckets[
+           uHash % SymTable_getBucketCount(oSymTable)];
+        psBinding != NULL;
+        psBinding = psBinding->psNextBinding)
+      if (psBinding->uHash == uHash &&
+          strcmp(psBinding->pcKey, pcKey) == 0)
+         return psBinding;
+
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the bindings of oSymTable to the next larger bucket count, if
+   there is one. Leave oSymTable unchanged if insufficient memory is
+   available, as it is still valid at its current size. */
+
+static void SymTable_expand(SymTable_T oSymTable)
+{
+   struct Binding **ppsNewBuckets;
+   struct Binding *psBinding;
+   struct Binding *psNextBinding;
+   size_t uOldCount;
+   size_t uNewCount;
+   size_t u;
+
+   assert(oSymTable != NULL);
+
+   if (oSymTable->uBucketCountIndex + 1 == NUM_BUCKET_COUNTS)
+      return;
+
+   uOldCount = SymTable_getBucketCount(oSymTable);
+   uNewCount = auBucketCounts[oSymTable->uBucketCountIndex + 1];
+   ppsNewBuckets = (struct Binding**)
+      calloc(uNewCount, sizeof(struct Binding*));
+   if (ppsNewBuckets == NULL)
+      return;
+
+   for (u = 0; u < uOldCount; u++)
+      for (psBinding = oSymTable->ppsBuckets[u]; psBinding != NULL;
+           psBinding = psNextBinding)
+      {
+         psNextBinding = psBinding->psNextBinding;
+         psBinding->psNextBinding =
+            ppsNewBuckets[psBinding->uHash % uNewCount];
+         ppsNewBuckets[psBinding->uHash % uNewCount] = psBinding;
+      }
+
+   free(oSymTable->ppsBuckets);
+   oSymTable->ppsBuckets = ppsNewBuckets;
+   oSymTable->uBucketCountIndex++;
+}
+
+/*--------------------------------------------------------------------*/
+
+SymTable_T SymTable_new(void)
+{
+   SymTable_T oSymTable;
+
+   oSymTable = (struct SymTable*)malloc(sizeof(struct SymTable));
+   if (oSymTable == NULL)
+      return NULL;
+
+   oSymTable->uLength = 0;
+   oSymTable->uBucketCountIndex = 0;
+   oSymTable->ppsBuckets = (struct Binding**)
+      calloc(auBucketCounts[0], sizeof(struct Binding*));
+   if (oSymTable->ppsBuckets == NULL)
+   {
+      free(oSymTable);
+      return NULL;
+   }
+
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_free(SymTable_T oSymTable)
+{
+   struct Binding *psBinding;
+   struct Binding *psNextBinding;
+   size_t u;
+
+   assert(oSymTable != NULL);
+
+   for (u = 0; u < SymTable_getBucketCount(oSymTable); u++)
+      for (psBinding = oSymTable->ppsBuckets[u]; psBinding != NULL;
+           psBinding = psNextBinding)
+      {
+         psNextBinding = psBinding->psNextBinding;
+         free((char*)psBinding->pcKey);
+         free(psBinding);
+      }
+
+   free(oSymTable->ppsBuckets);
+   free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+   assert(oSymTable != NULL);
+
+   return oSymTable->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey,
+                 const void *pvValue)
+{
+   struct Binding *psBinding;
+   size_t uHash;
+   size_t uBucket;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uHash = SymTable_hash(pcKey);
+   if (SymTable_find(oSymTable, pcKey, uHash) != NULL)
+      return 0;
+
+   psBinding = (struct Binding*)malloc(sizeof(struct Binding));
+   if (psBinding == NULL)
+      return 0;
+
+   psBinding->pcKey = (const char*)malloc(strlen(pcKey) + 1);
+   if (psBinding->pcKey == NULL)
+   {
+      free(psBinding);
+      return 0;
+   }
+   strcpy((char*)psBinding->pcKey, pcKey);
+   psBinding->uHash = uHash;
+   psBinding->pvValue = pvValue;
+
+   if (oSymTable->uLength == SymTable_getBucketCount(oSymTable))
+      SymTable_expand(oSymTable);
+
+   uBucket = uHash % SymTable_getBucketCount(oSymTable);
+   psBinding->psNextBinding = oSymTable->ppsBuckets[uBucket];
+   oSymTable->ppsBuckets[uBucket] = psBinding;
+   oSymTable->uLength++;
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
+                       const void *pvValue)
+{
+   struct Binding *psBinding;
+   const void *pvOldValue;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psBinding = SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey));
+   if (psBinding == NULL)
+      return NULL;
+
+   pvOldValue = psBinding->pvValue;
+   psBinding->pvValue = pvValue;
+   return (void*)pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   return SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey)) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+   struct Binding *psBinding;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   psBinding = SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey));
+   if (psBinding == NULL)
+      return NULL;
+
+   return (void*)psBinding->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+   struct Binding **ppsLink;
+   struct Binding *psBinding;
+   const void *pvOldValue;
+   size_t uHash;
+
+   assert(oSymTable != NULL);
+   assert(pcKey != NULL);
+
+   uHash = SymTable_hash(pcKey);
+   for (ppsLink = &oSymTable->ppsBuckets[
+           uHash % SymTable_getBucketCount(oSymTable)];
+        *ppsLink != NULL;
+        ppsLink = &(*ppsLink)->psNextBinding)
+   {
+      psBinding = *ppsLink;
+      if (psBinding->uHash == uHash &&
+          strcmp(psBinding->pcKey, pcKey) == 0)
+      {
+         *ppsLink = psBinding->psNextBinding;
+         pvOldValue = psBinding->pvValue;
+         free((char*)psBinding->pcKey);
+         free(psBinding);
+         oSymTable->uLength--;
+         return (void*)pvOldValue;
+      }
+   }
+
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SymTable_map(SymTable_T oSymTable,
+                  void (*pfApply)(const char *pcKey, void *pvValue,
+                                  void *pvExtra),
+                  const void *pvExtra)
+{
+   struct Binding *psBinding;
+   size_t u;
+
+   assert(oSymTable != NULL);
+   assert(pfApply != NULL);
+
+   for (u = 0; u < SymTable_getBucketCount(oSymTable); u++)
+      for (psBinding = oSymTable->ppsBuckets[u]; psBinding != NULL;
+           psBinding = psBinding->psNextBinding)
+         (*pfApply)(psBinding->pcKey, (void*)psBinding->pvValue,
+                    (void*)pvExtra);
+}
@@ -0,0 +1,88 @@
+/*--------------------------------------------------------------------*/
+/* symtable.h                                                         */
+/* Author: John Matters, Daniel Wang                                  */
+/*--------------------------------------------------------------------*/
+
+#ifndef SYMTABLE_INCLUDED
+#define SYMTABLE_INCLUDED
+
+#include <stddef.h>
+
+/* A SymTable_T is an unordered collection of bindings, each of which
+   maps a unique string key to a value. */
+
+typedef struct SymTable *SymTable_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty SymTable_T object, or NULL if insufficient
+   memory is available. */
+
+SymTable_T SymTable_new(void);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oSymTable, including its copies of the keys, but not the
+   values. */
+
+void SymTable_free(SymTable_T oSymTable);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings in oSymTable. */
+
+size_t SymTable_getLength(SymTable_T oSymTable);
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable does not contain a binding with key pcKey, add a new
+   binding from a copy of pcKey to pvValue and return 1 (TRUE).
+   Otherwise leave oSymTable unchanged and return 0 (FALSE). Also
+   return 0 (FALSE) if insufficient memory is available. */
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey,
+                 const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, replace its value
+   with pvValue and return the old value. Otherwise leave oSymTable
+   unchanged and return NULL. */
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey,
+                       const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if oSymTable contains a binding whose key is pcKey,
+   and 0 (FALSE) otherwise. */
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding within oSymTable whose key is
+   pcKey, or NULL if no such binding exists. */
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, remove that binding
+   and return its value. Otherwise leave oSymTable unchanged and
+   return NULL. */
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each binding in oSymTable, passing
+   pvExtra as an extra argument. That is, for each binding with key
+   pcKey and value pvValue, call (*pfApply)(pcKey, pvValue, pvExtra). */
+
+void SymTable_map(SymTable_T oSymTable,
+                  void (*pfApply)(const char *pcKey, void *pvValue,
+                                  void *pvExtra),
+                  const void *pvExtra);
+
+#endif